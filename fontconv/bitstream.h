@@ -2,73 +2,145 @@
 #define _BITSTREAM_H
 
 #include <stdint.h>
+#include <string.h>
 
+/*
+ * Bit arrays of uint32_t words, filled from the least significant bit.
+ * Header only, all functions are static inline, so it may be included anywhere,
+ * both by fontconv and by firmware.
+ */
+
+/*
+ * writer: bits are gathered in 64-bit accumulator and stored a word at a time.
+ * last incomplete word reaches memory only by bs_flush()
+ */
 typedef struct {
 	uint32_t *data;
-	uint32_t  cur_word;
-	uint32_t  mask;
-	int       cur_bit;
+	uint64_t  acc;      // pending bits, the first one is bit 0
+	int       acc_bits; // number of pending bits, less than 32 between calls
+	uint32_t  cur_word; // word, where accumulator goes to
 } bitstream_t;
 
-void bs_seek(bitstream_t *bs, uint32_t offset)
+static inline uint32_t bs_tell(const bitstream_t *bs)
 {
-	bs->cur_word = offset >> 5;
-	bs->cur_bit = offset & 0x1F;
-	bs->mask = 1 << bs->cur_bit;
+	return (bs->cur_word << 5) + bs->acc_bits;
 }
 
-uint32_t bs_tell(bitstream_t *bs)
+static inline void bs_flush(bitstream_t *bs)
 {
-	return (bs->cur_word << 5) + bs->cur_bit;
+	if(bs->acc_bits)
+		bs->data[bs->cur_word] = (uint32_t)bs->acc;
 }
 
-void bs_init(bitstream_t *bs, uint32_t *data)
+/*
+ * \brief set write position. bits of the word before position are kept
+ */
+static inline void bs_seek(bitstream_t *bs, uint32_t offset)
+{
+	bs_flush(bs);
+	bs->cur_word = offset >> 5;
+	bs->acc_bits = offset & 0x1F;
+	bs->acc = bs->acc_bits ? bs->data[bs->cur_word] & ((1u << bs->acc_bits) - 1) : 0;
+}
+
+static inline void bs_init(bitstream_t *bs, uint32_t *data)
 {
 	bs->data = data;
-	bs_seek(bs, 0);
+	bs->acc = 0;
+	bs->acc_bits = 0;
+	bs->cur_word = 0;
 }
 
-void bs_write_bit(bitstream_t *bs, int bit)
+/*
+ * \param size 0..32
+ */
+static inline void bs_write_bits(bitstream_t *bs, uint32_t chunk, int size)
 {
-	bs->data[bs->cur_word] &= ~bs->mask;
-	if(bit)
-		bs->data[bs->cur_word] |= bs->mask;
-	bs->cur_bit++;
-	bs->mask <<= 1;
-	if(bs->mask == 0) {
-		bs->cur_bit = 0;
-		bs->mask = 1;
-		bs->cur_word++;
+	bs->acc |= (uint64_t)(chunk & (uint32_t)((1ULL << size) - 1)) << bs->acc_bits;
+	bs->acc_bits += size;
+	if(bs->acc_bits >= 32) {
+		bs->data[bs->cur_word++] = (uint32_t)bs->acc;
+		bs->acc >>= 32;
+		bs->acc_bits -= 32;
 	}
 }
 
-void bs_write_bits(bitstream_t *bs, uint32_t chunk, int size)
+static inline void bs_write_bit(bitstream_t *bs, int bit)
 {
-	int size2 = bs->cur_bit + size - 32;
-	int size1 = 32 - bs->cur_bit;
-	
-	if(size2 > 0) {
-		// write to next word first
-		uint32_t mask2 = (1 << size2) - 1;
-		uint32_t chunk2 = (chunk >> size1) & mask2;
-		bs->data[bs->cur_word + 1] &= ~mask2;
-		bs->data[bs->cur_word + 1] |= chunk2;
-	}
-	else // fix first chunk size
-		size1 = size;
-	// write to current word
-	uint32_t mask = ((1 << size1) - 1) << bs->cur_bit;
-	chunk <<= bs->cur_bit;
-	chunk &= mask;
-	bs->data[bs->cur_word] &= ~mask;
-	bs->data[bs->cur_word] |= chunk;
-	
-	bs->cur_bit += size;
-	if(bs->cur_bit >= 32) {
-		bs->cur_bit &= 0x1F;
-		bs->cur_word++;
-	}
-	bs->mask = 1 << bs->cur_bit;
+	bs_write_bits(bs, bit != 0, 1);
+}
+
+/*
+ * reader. there is no end check, array must have one spare word after the last bit read.
+ * x86 reads unaligned, other CPUs word by word; define BS_WORD_READER to test that on PC
+ */
+typedef struct {
+	const uint32_t *data;
+	uint32_t offset;
+} bs_reader_t;
+
+static inline void bs_reader_init(bs_reader_t *r, const uint32_t *data, uint32_t offset)
+{
+	r->data = data;
+	r->offset = offset;
+}
+
+/*
+ * \brief next size bits, without moving read position
+ * \param size 0..32
+ */
+static inline uint32_t bs_peek(const bs_reader_t *r, int size)
+{
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(BS_WORD_READER)
+	// one 64-bit load of the word holding the first bit and the next one, which is
+	// at most the spare word: loading from the byte of the first bit would pass it
+	uint64_t w;
+	memcpy(&w, r->data + (r->offset >> 5), sizeof(w));
+	return (uint32_t)(w >> (r->offset & 31)) & (uint32_t)((1ULL << size) - 1);
+#else
+	// Cortex-M0: no unaligned loads, no shifted operands, 64-bit shifts are library calls.
+	// two aligned word loads and 32-bit shifts only, shift by 32 is avoided by branch
+	const uint32_t *p = r->data + (r->offset >> 5);
+	uint32_t shift = r->offset & 31, w = p[0] >> shift;
+	if(shift)
+		w |= p[1] << (32 - shift);
+	return size < 32 ? w & ((1u << size) - 1) : w;
+#endif
+}
+
+static inline void bs_skip(bs_reader_t *r, int size)
+{
+	r->offset += size;
+}
+
+/*
+ * \param size 0..32
+ */
+static inline uint32_t bs_read_bits(bs_reader_t *r, int size)
+{
+	uint32_t bits = bs_peek(r, size);
+	r->offset += size;
+	return bits;
+}
+
+static inline uint32_t bs_read_bit(bs_reader_t *r)
+{
+	uint32_t bit = (r->data[r->offset >> 5] >> (r->offset & 31)) & 1;
+	r->offset++;
+	return bit;
+}
+
+/*
+ * \brief append length bits of another bit array, starting at any bit
+ */
+static inline void bs_write_span(bitstream_t *bs, const uint32_t *src, uint32_t offset, int length)
+{
+	bs_reader_t r;
+	bs_reader_init(&r, src, offset);
+	for(; length >= 32; length -= 32)
+		bs_write_bits(bs, bs_read_bits(&r, 32), 32);
+	if(length > 0)
+		bs_write_bits(bs, bs_read_bits(&r, length), length);
 }
 
 #endif // _BITSTREAM_H
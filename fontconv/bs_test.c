@@ -1,26 +1,108 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "bitstream.h"
 
+/*
+ * round-trip test and benchmark of bitstream.h
+ * gcc -O2 bs_test.c -o bs_test && ./bs_test
+ * gcc -O2 -DBS_WORD_READER bs_test.c -o bs_test && ./bs_test   (reader used on Cortex-M0)
+ */
+
+#define TEST_WORDS (1 << 20)
+#define TEST_CHUNKS (TEST_WORDS / 2)
+
+static uint32_t data[TEST_WORDS + 1], copy[TEST_WORDS + 1];
+static uint32_t values[TEST_CHUNKS];
+static uint8_t sizes[TEST_CHUNKS];
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
 int main(int argc, char *argv[])
 {
 	bitstream_t bs;
-	uint32_t data[40];
-	uint32_t i, j;
-	
-	for(i = 0; i < 40; i++)
-		data[i] = 0;
+	bs_reader_t r;
+	uint32_t i, bits = 0, failures = 0, sum = 0;
+	clock_t start;
+
+	srand(1);
+	for(i = 0; i < TEST_CHUNKS; i++)
+	{
+		sizes[i] = rand() % 33;
+		values[i] = ((uint32_t)rand() << 16 ^ rand()) & (uint32_t)((1ULL << sizes[i]) - 1);
+		bits += sizes[i];
+	}
+
+	// write chunks of 0..32 bits
+	start = clock();
 	bs_init(&bs, data);
-	for(i = 1; i < 32; i++)
+	for(i = 0; i < TEST_CHUNKS; i++)
+		bs_write_bits(&bs, values[i], sizes[i]);
+	bs_flush(&bs);
+	printf("write: %.1f Mbit/s\n", bits / seconds(start) / 1e6);
+	failures += bs_tell(&bs) != bits;
+
+	// read them back
+	start = clock();
+	bs_reader_init(&r, data, 0);
+	for(i = 0; i < TEST_CHUNKS; i++)
+		failures += bs_read_bits(&r, sizes[i]) != values[i];
+	printf("read:  %.1f Mbit/s\n", bits / seconds(start) / 1e6);
+
+	// peek and skip
+	bs_reader_init(&r, data, 0);
+	for(i = 0; i < TEST_CHUNKS; i++)
+	{
+		failures += bs_peek(&r, sizes[i]) != values[i];
+		bs_skip(&r, sizes[i]);
+	}
+
+	// single bits
+	start = clock();
+	bs_reader_init(&r, data, 0);
+	for(i = 0; i < bits; i++)
+		sum += bs_read_bit(&r);
+	printf("read bit by bit: %.1f Mbit/s (%u ones)\n", bits / seconds(start) / 1e6, sum);
+
+	// copy of whole stream from odd position, then compare with source
+	start = clock();
+	bs_init(&bs, copy);
+	bs_write_bits(&bs, 5, 3);
+	bs_write_span(&bs, data, 0, bits);
+	bs_flush(&bs);
+	printf("span:  %.1f Mbit/s\n", bits / seconds(start) / 1e6);
+	bs_reader_init(&r, copy, 3);
+	for(i = 0; i < TEST_CHUNKS; i++)
+		failures += bs_read_bits(&r, sizes[i]) != values[i];
+
+	// buffer of exact size, last bit in the last word before the spare one: reads must not pass it
 	{
-		bs_write_bits(&bs, (1 << i) - 1, i);
-		bs_write_bits(&bs, 0, i);
+		uint32_t words = (bits + 31) / 32 + 1, *exact = malloc(words * sizeof(uint32_t));
+		memcpy(exact, data, words * sizeof(uint32_t));
+		bs_reader_init(&r, exact, 0);
+		for(i = 0; i < TEST_CHUNKS; i++)
+			failures += bs_read_bits(&r, sizes[i]) != values[i];
+		// decoders peek a full word past the end, the spare word is zero
+		failures += bs_peek(&r, 32) != 0;
+		free(exact);
+	}
+
+	// seek keeps bits before position
+	bs_init(&bs, copy);
+	bs_seek(&bs, 1);
+	bs_write_bits(&bs, 2, 2);
+	bs_flush(&bs);
+	failures += (copy[0] & 7) != 5;
+
+	if(failures) {
+		printf("%u checks failed\n", failures);
+		return 1;
 	}
-	for(i = 0; i < 40; i++)
-		for(j = 0; j < 32; j++)
-		{
-			putchar(data[i] & 1 ? '#' : '.');
-			data[i] >>= 1;
-		}
+	printf("all tests passed\n");
 	return 0;
 }
@@ -0,0 +1,125 @@
+/*
+ * charset.h
+ *
+ *  Text decoding for display output: UTF-8 and Windows-1251 to Unicode codepoints,
+ *  and codepoint to glyph index mapping by table of ranges.
+ *  The one range table and lookup for 6x8 charcell font (lcd_putc()) and microfont
+ *  (mf_find_glyph() in microfont.h), decoders are shared by firmware and fontconv.
+ *  Header only, like bitstream.h: tables are static, in firmware only lcd_nokia.c decodes
+ *  text (lcd_next_char()), so they are not duplicated.
+ */
+
+#ifndef CHARSET_H_
+#define CHARSET_H_
+
+#include <stdint.h>
+
+#define CHARSET_INVALID 0xFFFD // Unicode replacement character, returned for broken sequences
+
+/*
+ * \brief range of consecutive codepoints, mapped to consecutive glyphs of a font
+ */
+typedef struct {
+	uint32_t first; // first codepoint of the range
+	uint16_t count; // number of codepoints in the range
+	uint16_t base;  // glyph index for the first codepoint (microfont: index in offset table)
+} glyph_range_t;
+
+/*
+ * UTF-8 sequence length by high nibble of lead byte, 0 for continuation bytes
+ */
+static const uint8_t charset_utf8_length[16] = {
+	1, 1, 1, 1, 1, 1, 1, 1, // 0xxxxxxx: ASCII
+	0, 0, 0, 0,             // 10xxxxxx: continuation
+	2, 2,                   // 110xxxxx
+	3,                      // 1110xxxx
+	4                       // 11110xxx
+};
+
+/*
+ * Unicode codepoints for Windows-1251 chars 0x80..0xBF.
+ * 0xC0..0xFF are plain U+0410..U+044F and need no table.
+ */
+static const uint16_t charset_cp1251_high[64] = {
+	0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021, // 0x80
+	0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F, // 0x88
+	0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, // 0x90
+	0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F, // 0x98
+	0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7, // 0xA0
+	0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407, // 0xA8
+	0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7, // 0xB0
+	0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457  // 0xB8
+};
+
+/*
+ * \brief Decode one UTF-8 char and advance string pointer.
+ *        Stops at zero byte, if sequence is truncated.
+ * \param s pointer to string pointer, must not point at zero byte
+ * \return codepoint, or CHARSET_INVALID for malformed sequence
+ */
+static inline uint32_t charset_utf8_decode(const unsigned char **s)
+{
+	const unsigned char *p = *s;
+	uint32_t c = *p++;
+	int n = charset_utf8_length[c >> 4];
+
+	if(n == 1) {
+		*s = p;
+		return c;
+	}
+	if(n == 0 || c < 0xC2 || c > 0xF4) {
+		// stray continuation byte, overlong 2-byte form or out of Unicode range
+		*s = p;
+		return CHARSET_INVALID;
+	}
+	c &= 0x7F >> n;
+	while(--n)
+	{
+		// zero byte is not a continuation, so we never run past the end of string
+		if((*p & 0xC0) != 0x80) {
+			*s = p;
+			return CHARSET_INVALID;
+		}
+		c = (c << 6) | (*p++ & 0x3F);
+	}
+	*s = p;
+	return c;
+}
+
+/*
+ * \brief Convert Windows-1251 char to Unicode codepoint
+ */
+static inline uint32_t charset_cp1251_decode(unsigned char c)
+{
+	if(c < 0x80)
+		return c;
+	if(c >= 0xC0)
+		return c + (0x0410 - 0xC0);
+	return charset_cp1251_high[c - 0x80];
+}
+
+/*
+ * \brief Find glyph for codepoint by binary search in sorted range table
+ * \param ranges table of ranges, sorted by first codepoint, ranges must not overlap
+ * \param count number of entries in table
+ * \param c codepoint
+ * \return glyph index, or -1 if font has no such char
+ */
+static inline int charset_find_glyph(const glyph_range_t *ranges, int count, uint32_t c)
+{
+	int lo = 0, hi = count, mid;
+
+	while(lo < hi)
+	{
+		mid = (lo + hi) >> 1;
+		if(c < ranges[mid].first)
+			hi = mid;
+		else if(c - ranges[mid].first >= ranges[mid].count)
+			lo = mid + 1;
+		else
+			return ranges[mid].base + (c - ranges[mid].first);
+	}
+	return -1;
+}
+
+#endif /* CHARSET_H_ */
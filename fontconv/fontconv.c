@@ -13,159 +13,673 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "bitstream.h"
 #include "microfont.h"
+#include "charset.h"
 
 typedef struct {
 	int index, height, width;
-	char bits[MF_MAX_FONT_H][MF_MAX_FONT_W];
+	int x_offset, y_offset; // BBX offsets of bitmap from glyph origin
+	int advance;            // DWIDTH x
+	uint32_t rows[MF_MAX_FONT_H]; // bitmap rows, leftmost pixel is bit 31
 } char_data_t;
 
-int bdf_read_char(FILE *f, char_data_t *c)
+#define CHAR_PIXEL(c, x, y) (((c)->rows[y] >> (31 - (x))) & 1)
+
+/*
+ * BDF source, whole file in memory
+ */
+typedef struct {
+	const char *cur, *end;
+} bdf_source_t;
+
+/*
+ * hex digit values, -1 for other chars
+ */
+static signed char hex_value[256];
+
+static void bdf_init_tables(void)
 {
-	int i, h, w, j, k, code;
-	char buf[20];
-	uint32_t line;
+	int i;
+	memset(hex_value, -1, sizeof(hex_value));
+	for(i = 0; i < 10; i++)
+		hex_value['0' + i] = i;
+	for(i = 0; i < 6; i++)
+		hex_value['A' + i] = hex_value['a' + i] = 10 + i;
+}
 
-	while((code = fscanf(f, "STARTCHAR %d", &i)) != 1)
-	{
-		if(code == EOF)
-			return -1;
-		fgetc(f);
+/*
+ * \return next line of source, NULL at the end. line is not zero-terminated!
+ */
+static const char *bdf_next_line(bdf_source_t *src, const char **line_end)
+{
+	const char *line = src->cur, *eol;
+	if(line >= src->end)
+		return NULL;
+	eol = memchr(line, '\n', src->end - line);
+	if(eol == NULL)
+		eol = src->end;
+	src->cur = eol + 1;
+	*line_end = eol;
+	return line;
+}
+
+/*
+ * \return pointer after keyword if line starts with it, NULL otherwise
+ */
+static const char *bdf_keyword(const char *line, const char *line_end, const char *keyword, int length)
+{
+	if(line_end - line < length || memcmp(line, keyword, length) != 0)
+		return NULL;
+	line += length;
+	// keyword must end here, "BITMAP" is not "BITMAPS"
+	if(line < line_end && !isspace((unsigned char)*line))
+		return NULL;
+	return line;
+}
+
+#define BDF_KEYWORD(line, line_end, kw) bdf_keyword(line, line_end, kw, sizeof(kw) - 1)
+
+/*
+ * parse decimal number, advance pointer
+ */
+static int bdf_number(const char **p, const char *end)
+{
+	const char *s = *p;
+	int n = 0, negative = 0;
+	while(s < end && (*s == ' ' || *s == '\t'))
+		s++;
+	if(s < end && *s == '-') {
+		negative = 1;
+		s++;
 	}
-	while((code = fscanf(f, "BBX %d %d %d %d", &w, &h, &j, &k)) != 4)
+	while(s < end && *s >= '0' && *s <= '9')
+		n = n * 10 + *s++ - '0';
+	*p = s;
+	return negative ? -n : n;
+}
+
+/*
+ * parse hex bitmap row, up to 32 pixels
+ */
+static uint32_t bdf_hex_row(const char *p, const char *end)
+{
+	uint32_t row = 0;
+	int n = 0, d;
+	while(p < end && n < 8 && (d = hex_value[(unsigned char)*p]) >= 0)
 	{
-		if(code == EOF)
-			return -1;
-		fgetc(f);
+		row = (row << 4) | d;
+		p++;
+		n++;
 	}
-	do {
-		while((code = fscanf(f, "%19s", buf)) != 1)
-			if(code == EOF)
-				return -1;
-	} while(strcmp(buf, "BITMAP") != 0);
-	if(w > MF_MAX_FONT_W || h > MF_MAX_FONT_H)
-		return -1;
-	c->height = h;
-	c->width = w;
-	c->index = i;
-	if(h && w)
-		for(i = 0; i < h; i++)
-		{
-			fscanf(f, "%8s", buf);
-			for(j = 0; j < strlen(buf); j++)
+	// left-align: first pixel goes to bit 31
+	return n ? row << (32 - 4 * n) : 0;
+}
+
+/*
+ * \brief read next glyph from BDF source, single pass over lines
+ * \return 0 if glyph is read, 1 if glyph is skipped (too big, not encoded), -1 at the end of source
+ */
+int bdf_read_char(bdf_source_t *src, char_data_t *c)
+{
+	const char *line, *line_end, *p;
+	int i, in_char = 0, too_big = 0;
+
+	while((line = bdf_next_line(src, &line_end)) != NULL)
+	{
+		if(!in_char) {
+			// glyph name after STARTCHAR is just a name, it's ENCODING that matters
+			if(BDF_KEYWORD(line, line_end, "STARTCHAR")) {
+				in_char = 1;
+				memset(c, 0, sizeof(*c));
+				c->index = -1;
+			}
+			continue;
+		}
+		if((p = BDF_KEYWORD(line, line_end, "ENCODING")) != NULL)
+			c->index = bdf_number(&p, line_end);
+		else if((p = BDF_KEYWORD(line, line_end, "DWIDTH")) != NULL)
+			c->advance = bdf_number(&p, line_end);
+		else if((p = BDF_KEYWORD(line, line_end, "BBX")) != NULL) {
+			c->width = bdf_number(&p, line_end);
+			c->height = bdf_number(&p, line_end);
+			c->x_offset = bdf_number(&p, line_end);
+			c->y_offset = bdf_number(&p, line_end);
+			too_big = c->width > MF_MAX_FONT_W || c->height > MF_MAX_FONT_H;
+		}
+		else if(BDF_KEYWORD(line, line_end, "BITMAP")) {
+			for(i = 0; i < c->height; i++)
 			{
-				int quad = buf[j];
-				if(quad >= 'A')
-					quad = quad - 'A' + 10;
-				else
-					quad -= '0';
-				for(k = 0; k < 4; k++)
-					c->bits[i][j*4 + k] = (quad >> (3 - k)) & 1;
+				if((line = bdf_next_line(src, &line_end)) == NULL)
+					return -1;
+				if(!too_big)
+					c->rows[i] = bdf_hex_row(line, line_end);
 			}
 		}
+		else if(BDF_KEYWORD(line, line_end, "ENDCHAR"))
+			return (too_big || c->index < 0) ? 1 : 0;
+	}
 
-	return 0;
+	return -1;
 }
 
-int char_cmp(const char_data_t *c1, const char_data_t *c2)
+/*
+ * \return nonzero if length bits of a, starting at a_offset, are equal to first length bits of b.
+ * arrays must have one spare word at the end
+ */
+static int bits_match(const uint32_t *a, uint32_t a_offset, const uint32_t *b, int length)
 {
-	int i, j;
-	if(c1->height != c2->height || c1->width != c2->width)
-		return 1;
-	for(i = 0; i < c1->height; i++)
-		for(j = 0; j < c1->width; j++)
-			if(c1->bits[i][j] != c2->bits[i][j])
-				return 1;
-	return 0;
+	bs_reader_t ra, rb;
+	int n;
+	bs_reader_init(&ra, a, a_offset);
+	bs_reader_init(&rb, b, 0);
+	for(; length > 0; length -= n)
+	{
+		n = length < 32 ? length : 32;
+		if(bs_read_bits(&ra, n) != bs_read_bits(&rb, n))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * FNV-1a hash of encoded glyph
+ */
+static uint32_t bits_hash(const uint32_t *data, int length)
+{
+	uint32_t hash = 2166136261u ^ length;
+	int i;
+	for(i = 0; i < (length + 31) >> 5; i++)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+/*
+ * encoded glyph, for looking up equal ones
+ */
+typedef struct {
+	uint32_t hash;
+	int      index;          // codepoint of the first char with such glyph
+	int      offset, length; // length is 0 for free hash table entry
+} glyph_hash_t;
+
+/*
+ * \brief move bitmaps to common cell by BBX offsets: baseline is at the same row for all chars.
+ *        cell height is from the highest ascent to the lowest descent, cell width is advance,
+ *        or bitmap width, if it is wider
+ * \return cell height, 0 if it is too high
+ */
+static int place_chars(char_data_t *chars, int count)
+{
+	uint32_t rows[MF_MAX_FONT_H];
+	int i, y, x, top, ascent = -MF_MAX_FONT_H, descent = -MF_MAX_FONT_H;
+
+	for(i = 0; i < count; i++)
+		if(chars[i].height && chars[i].width) {
+			if(chars[i].y_offset + chars[i].height > ascent)
+				ascent = chars[i].y_offset + chars[i].height;
+			if(-chars[i].y_offset > descent)
+				descent = -chars[i].y_offset;
+		}
+	if(ascent + descent <= 0) {
+		// all chars are blank
+		ascent = 1;
+		descent = 0;
+	}
+	if(ascent + descent > MF_MAX_FONT_H)
+		return 0;
+
+	for(i = 0; i < count; i++)
+	{
+		char_data_t *c = &chars[i];
+		// pixels left of origin are not supported, glyph is moved right
+		x = c->x_offset < 0 ? 0 : c->x_offset;
+		top = ascent - (c->y_offset + c->height);
+		memset(rows, 0, sizeof(rows));
+		if(c->width)
+			for(y = 0; y < c->height; y++)
+				rows[top + y] = x < 32 ? c->rows[y] >> x : 0;
+		memcpy(c->rows, rows, sizeof(rows));
+		c->width = c->width ? x + c->width : 0;
+		if(c->advance > c->width)
+			c->width = c->advance;
+		if(c->width > MF_MAX_FONT_W)
+			c->width = MF_MAX_FONT_W;
+		// blank glyph like space is kept, so it's not replaced by fallback
+		if(c->width == 0)
+			c->width = 1;
+		c->height = ascent + descent;
+		c->x_offset = c->y_offset = 0;
+	}
+	return ascent + descent;
 }
 
-int make_microfont(const char_data_t *chars, microfont_t *font, int duplicateBitmaps)
+static int char_index_cmp(const void *c1, const void *c2)
+{
+	return ((const char_data_t *)c1)->index - ((const char_data_t *)c2)->index;
+}
+
+/*
+ * gap in codepoints, starting new range from. every missing char inside a range costs
+ * 2 bytes of offset table, new range costs sizeof(glyph_range_t) == 8 bytes
+ */
+#define MF_RANGE_GAP ((int)(sizeof(glyph_range_t) / sizeof(uint16_t)))
+
+/*
+ * decoder cost estimate for Cortex-M0 in cycles, see microfont.h
+ */
+#define CYCLES_PER_BIT   8
+#define CYCLES_PER_RUN   10
+#define CYCLES_PER_PIXEL 12
+#define CYCLES_PER_BYTE  8 // page order, copy
+
+/*
+ * longest encoded glyph: RLE with k=7 spends 8 bits per pixel, plus width and one empty run
+ */
+#define MAX_GLYPH_WORDS ((MF_MAX_FONT_W * MF_MAX_FONT_H * 8 + 2 * 32) / 32 + 2)
+
+typedef struct {
+	int duplicateBitmaps; // store bitmaps for equally looking chars
+	int shareBits;        // look for glyph bits inside of other glyphs
+	int flags;            // MF_FLAG_*, glyph encoding
+	int quiet;            // no report for every glyph
+	int fallback;         // codepoint of glyph for chars missing in font
+} make_options_t;
+
+typedef struct {
+	uint32_t worst_cycles, total_cycles; // decoding cost of glyphs
+	int      worst_index, glyphs;
+} decode_cost_t;
+
+static void write_rice(bitstream_t *bs, uint32_t n, int k)
+{
+	uint32_t q;
+	// unary part: q ones and zero
+	for(q = n >> k; q >= 32; q -= 32)
+		bs_write_bits(bs, 0xFFFFFFFF, 32);
+	bs_write_bits(bs, (1u << q) - 1, q + 1);
+	bs_write_bits(bs, n, k);
+}
+
+/*
+ * \brief tight box of glyph pixels in its cell, height is 0 for blank glyph
+ */
+static void char_box(const char_data_t *c, int height, int *x, int *y, int *width, int *box_height)
+{
+	uint32_t columns = 0;
+	int i, top = -1, bottom = -1;
+
+	for(i = 0; i < height; i++)
+		if(c->rows[i]) {
+			if(top < 0)
+				top = i;
+			bottom = i;
+			columns |= c->rows[i];
+		}
+	if(top < 0) {
+		*x = *y = *width = *box_height = 0;
+		return;
+	}
+	*y = top;
+	*box_height = bottom - top + 1;
+	// leftmost pixel is bit 31
+	*x = __builtin_clz(columns);
+	*width = 32 - __builtin_ctz(columns) - *x;
+}
+
+/*
+ * \brief encode glyph: width, box if font has boxes, then pixels, as font flags say
+ * \param runs number of runs for RLE encoding, 0 for raw one
+ * \param pixels number of pixels stored
+ * \return length in bits
+ */
+static int encode_glyph(const char_data_t *c, const microfont_t *font, uint32_t *bits, int *runs, int *pixels)
 {
-	int i, j, n, max_w;
 	bitstream_t bs;
-	
-	font->magic = 0xface;
+	int i, x, y, rows, k = (font->flags & MF_FLAG_RICE_K) >> MF_FLAG_RICE_K_SHIFT;
+	int box_x = 0, box_y = 0, box_width = c->width, box_height = font->height;
+	uint32_t pixel, color = 0, run = 0;
+
+	memset(bits, 0, MAX_GLYPH_WORDS * sizeof(uint32_t));
+	bs_init(&bs, bits);
+	bs_write_bits(&bs, c->width - 1, font->widthbits);
+	if(font->flags & MF_FLAG_BOX) {
+		char_box(c, font->height, &box_x, &box_y, &box_width, &box_height);
+		bs_write_bits(&bs, box_x, font->widthbits);
+		bs_write_bits(&bs, box_y, mf_ybits(font));
+		bs_write_bits(&bs, box_height, mf_ybits(font));
+		if(box_height)
+			bs_write_bits(&bs, box_width - 1, font->widthbits);
+	}
+	*runs = 0;
+	*pixels = box_width * box_height;
+	if((font->flags & MF_FLAG_ORDER) == MF_ORDER_PAGES) {
+		// bytes of display memory, page by page. rows below glyph are zero
+		for(y = 0; y < font->height; y += 8)
+			for(x = 0; x < c->width; x++)
+			{
+				for(pixel = i = 0; i < 8; i++)
+					pixel |= CHAR_PIXEL(c, x, y + i) << i;
+				bs_write_bits(&bs, pixel, 8);
+			}
+		bs_flush(&bs);
+		return bs_tell(&bs);
+	}
+	// by columns or by rows, pixel by pixel
+	rows = (font->flags & MF_FLAG_ORDER) == MF_ORDER_ROWS;
+	for(i = 0; i < *pixels; i++)
+	{
+		x = rows ? i % box_width : i / box_height;
+		y = rows ? i / box_width : i % box_height;
+		pixel = CHAR_PIXEL(c, box_x + x, box_y + y);
+		if((font->flags & MF_FLAG_ENCODING) == MF_ENCODING_RAW)
+			bs_write_bit(&bs, pixel);
+		else if(pixel == color)
+			run++;
+		else {
+			// runs alternate, starting with white one, which may be empty
+			write_rice(&bs, run, k);
+			(*runs)++;
+			color = pixel;
+			run = 1;
+		}
+	}
+	if((font->flags & MF_FLAG_ENCODING) == MF_ENCODING_RLE && run) {
+		write_rice(&bs, run, k);
+		(*runs)++;
+	}
+	bs_flush(&bs);
+	return bs_tell(&bs);
+}
+
+/*
+ * find place for encoded glyph in bit stream of already added glyphs:
+ * whole glyph inside of stream, or its beginning at the end of stream.
+ * align is 8 for page order, where glyphs must start at byte
+ * \return offset in stream, bs_tell() if nothing is shared
+ */
+static uint32_t find_shared_bits(const uint32_t *stream, uint32_t stream_length,
+		const uint32_t *glyph, int length, int align)
+{
+	uint32_t offset;
+	int n;
+	for(offset = 0; offset < stream_length; offset += align)
+	{
+		n = stream_length - offset < (uint32_t)length ? stream_length - offset : (uint32_t)length;
+		if(bits_match(stream, offset, glyph, n))
+			break;
+	}
+	return offset;
+}
+
+/*
+ * \brief build microfont from glyphs, sorted by codepoint.
+ *        equal glyphs always share bitmap, unless options->duplicateBitmaps is set.
+ *        options->shareBits makes it look for glyph bits inside of other glyphs, or partially
+ *        at the end of stream. that is slow, each glyph is compared with every bit position of stream
+ * \param cost filled with decoding cost estimate
+ * \return font block, allocated with malloc, or NULL if font won't fit
+ */
+microfont_t *make_microfont(const char_data_t *chars, int count, const make_options_t *options, decode_cost_t *cost)
+{
+	int i, n, max_w, ranges, glyphs, length, runs, pixels, *slot, hash_mask, dups = 0;
+	uint32_t offset, hash, cycles, stream_bits = 0, glyph_bits[MAX_GLYPH_WORDS];
+	size_t header_size;
+	microfont_t *font;
+	glyph_range_t *range;
+	uint16_t *offsets;
+	uint32_t *bits;
+	glyph_hash_t *hashes, *h;
+	bitstream_t bs;
+
+	// count ranges and offset table entries, small gaps are filled by empty entries
+	ranges = glyphs = 0;
+	slot = malloc(count * sizeof(int));
+	for(i = 0; i < count; i++)
+	{
+		if(i == 0 || chars[i].index - chars[i - 1].index > MF_RANGE_GAP) {
+			ranges++;
+			glyphs++;
+		}
+		else
+			glyphs += chars[i].index - chars[i - 1].index;
+		slot[i] = glyphs - 1;
+	}
+	if(glyphs >= MF_NO_GLYPH) {
+		fprintf(stderr, "too many chars: %d\n", glyphs);
+		return NULL;
+	}
+
+	header_size = sizeof(microfont_t) + ranges * sizeof(glyph_range_t) + ((glyphs + 1) & ~1) * sizeof(uint16_t);
+	// spare word for bits_match()
+	font = calloc(1, header_size + MF_MAX_FONT_DATA + sizeof(uint32_t));
+	font->magic = MF_MAGIC;
+	font->version = MF_VERSION;
+	font->flags = options->flags;
+	font->ranges = ranges;
+	font->glyphs = glyphs;
+	font->fallback = MF_NO_GLYPH;
 	font->height = 1;
 	max_w = 0;
-	for(i = 0; i < MF_FONT_CHARS; i++)
+	for(i = 0; i < count; i++)
 	{
-		if(chars[i].index == 0 || chars[i].width == 0 || chars[i].height == 0)
-			continue;
-//		fprintf(stderr, "i: %02x, w: %d, h: %d\n", i, chars[i].width, chars[i].height);
 		if(chars[i].height > font->height)
 			font->height = chars[i].height;
 		if(chars[i].width > max_w)
 			max_w = chars[i].width;
+		if(chars[i].index == options->fallback)
+			font->fallback = slot[i];
 	}
 	// width cannot be 0, so we can safely decrement it and save 1 bit when width=8 :)
 	max_w--;
 	font->widthbits = 0;
-	while(max_w)
+	while(max_w > 0)
 	{
 		font->widthbits++;
 		max_w >>= 1;
 	}
-	fprintf(stderr, "widthbits: %d, height: %d\n", font->widthbits, font->height);
-	
-	bs_init(&bs, font->bits);
-	for(i = 0; i < MF_FONT_CHARS; i++)
+	// page order: width takes whole byte, so glyph bytes are aligned
+	if((font->flags & MF_FLAG_ORDER) == MF_ORDER_PAGES)
+		font->widthbits = 8;
+	if(!options->quiet)
+		fprintf(stderr, "widthbits: %d, height: %d, ranges: %d, offsets: %d\n",
+			font->widthbits, font->height, ranges, glyphs);
+
+	// range table
+	range = (glyph_range_t *)mf_ranges(font) - 1;
+	for(i = 0; i < count; i++)
 	{
-		if(chars[i].index == 0 || chars[i].width == 0 || chars[i].height == 0) {
-			font->index[i] = MF_EMPTY_CHAR;
-			continue;
+		if(i == 0 || slot[i] - slot[i - 1] != chars[i].index - chars[i - 1].index) {
+			range++;
+			range->first = chars[i].index;
+			range->base = slot[i];
 		}
-		if(bs_tell(&bs) >= MF_EMPTY_CHAR) {
-			fprintf(stderr, "char %02x won't fit!\n", i + MF_FIRST_CHAR);
-			return -1;
+		range->count = chars[i].index - range->first + 1;
+	}
+
+	offsets = (uint16_t *)mf_offsets(font);
+	for(i = 0; i < glyphs; i++)
+		offsets[i] = MF_EMPTY_CHAR;
+
+	memset(cost, 0, sizeof(*cost));
+
+	// hash table of added glyphs, at most half full
+	for(hash_mask = 1; hash_mask < 2 * count; hash_mask <<= 1);
+	hashes = calloc(hash_mask--, sizeof(glyph_hash_t));
+
+	bits = (uint32_t *)mf_bits(font);
+	bs_init(&bs, bits);
+	for(i = 0; i < count; i++)
+	{
+		// encode glyph apart from stream first, to compare it with already added ones
+		length = encode_glyph(&chars[i], font, glyph_bits, &runs, &pixels);
+		if((font->flags & MF_FLAG_ORDER) == MF_ORDER_PAGES)
+			cycles = font->widthbits * CYCLES_PER_BIT + (length - font->widthbits) / 8 * CYCLES_PER_BYTE;
+		else
+			cycles = length * CYCLES_PER_BIT + runs * CYCLES_PER_RUN + pixels * CYCLES_PER_PIXEL;
+		if(font->flags & MF_FLAG_BOX)
+			// cell is cleared first
+			cycles += chars[i].width * ((font->height + 7) >> 3) * CYCLES_PER_BYTE;
+		if(cycles > cost->worst_cycles) {
+			cost->worst_cycles = cycles;
+			cost->worst_index = chars[i].index;
 		}
-		if(!duplicateBitmaps) {
-			// try to find same looking chars from already added to font
-			for(j = 0; j < i; j++)
-				if(char_cmp(&(chars[i]), &(chars[j])) == 0) {
-					// found! lets duplicate pointer, not bitmap
-					font->index[i] = font->index[j];
-					fprintf(stderr, "found dup char: 0x%02x '%c' looks same as 0x%02x '%c'\n",
-						i + MF_FIRST_CHAR, i + MF_FIRST_CHAR, j + MF_FIRST_CHAR, j + MF_FIRST_CHAR);
-					break;
-				}
-			if(j < i)
-				continue; // duplicate found and added, go to next char
+		cost->total_cycles += cycles;
+		cost->glyphs++;
+
+		hash = bits_hash(glyph_bits, length);
+		for(h = &hashes[hash & hash_mask]; h->length; h = &hashes[(h - hashes + 1) & hash_mask])
+			if(h->hash == hash && h->length == length && bits_match(bits, h->offset, glyph_bits, length))
+				break;
+		if(h->length && !options->duplicateBitmaps) {
+			// found! lets duplicate pointer, not bitmap
+			offsets[slot[i]] = h->offset;
+			if(!options->quiet)
+				fprintf(stderr, "found dup char: U+%04X looks same as U+%04X\n", chars[i].index, h->index);
+			dups++;
+			continue;
 		}
-		fprintf(stderr, "%02x '%c', w:%2d, offset: %d\n",
-			i + MF_FIRST_CHAR, i + MF_FIRST_CHAR, chars[i].width, bs_tell(&bs));
 
-		font->index[i] = bs_tell(&bs);
-		bs_write_bits(&bs, chars[i].width - 1, font->widthbits);
-		
-		// TODO: let choose bitstream direction, now only "up-down" implemented
-		for(j = 0; j < chars[i].width; j++)
-			for(n = 0; n < font->height; n++)
-				bs_write_bit(&bs, chars[i].bits[n][j]);
+		offset = !options->shareBits ? bs_tell(&bs) : find_shared_bits(bits, bs_tell(&bs), glyph_bits, length,
+			(font->flags & MF_FLAG_ORDER) == MF_ORDER_PAGES ? 8 : 1);
+		n = length - (int)(bs_tell(&bs) - offset); // bits to append
+		if(n < 0)
+			n = 0;
+		if(bs_tell(&bs) + n > MF_MAX_FONT_DATA * 8 || offset >= MF_EMPTY_CHAR) {
+			if(!options->quiet)
+				fprintf(stderr, "char U+%04X won't fit!\n", chars[i].index);
+			free(hashes);
+			free(slot);
+			free(font);
+			return NULL;
+		}
+		if(options->quiet)
+			;
+		else if(n < length)
+			fprintf(stderr, "U+%04X, w:%2d, offset: %d, shares %d bits\n",
+				chars[i].index, chars[i].width, offset, length - n);
+		else
+			fprintf(stderr, "U+%04X, w:%2d, offset: %d\n", chars[i].index, chars[i].width, offset);
+		stream_bits += length;
+
+		offsets[slot[i]] = offset;
+		bs_write_span(&bs, glyph_bits, length - n, n);
+		// stream is read back for dedup and sharing
+		bs_flush(&bs);
+		if(!h->length) {
+			h->hash = hash;
+			h->index = chars[i].index;
+			h->offset = offset;
+			h->length = length;
+		}
 	}
+	if(!options->quiet)
+		fprintf(stderr, "%d duplicate chars, %d bits shared\n", dups, stream_bits - bs_tell(&bs));
+	free(hashes);
+	free(slot);
 
-	return ((bs_tell(&bs) + 31) >> 5) << 2;
+	// spare word for readers, which load two words at once
+	font->size = header_size + (((bs_tell(&bs) + 31) >> 5) << 2) + sizeof(uint32_t);
+	return font;
 }
 
-void debug_show_font(char_data_t *chars)
+void debug_show_font(const char_data_t *chars, int count)
 {
 	int i, j, k;
- 	for(i = 0; i < MF_FONT_CHARS; i++)
+	for(i = 0; i < count; i++)
 	{
-		if(chars[i].index) {
-			fprintf(stderr, "i: 0x%02x '%c', h: %d, w: %d\n",
-					chars[i].index, chars[i].index, chars[i].height, chars[i].width);
-			for(j = 0; j < chars[i].height; j++)
-			{
-				for(k = 0; k < chars[i].width; k++)
-					fputc(chars[i].bits[j][k] ? '#' : '.', stderr);
-				fputc('\n', stderr);
-			}
+		fprintf(stderr, "U+%04X, h: %d, w: %d\n", chars[i].index, chars[i].height, chars[i].width);
+		for(j = 0; j < chars[i].height; j++)
+		{
+			for(k = 0; k < chars[i].width; k++)
+				fputc(CHAR_PIXEL(&chars[i], k, j) ? '#' : '.', stderr);
+			fputc('\n', stderr);
 		}
 	}
 }
 
+/*
+ * codepoint ranges selected by -r option, all chars from 0x20 if none
+ */
+#define MAX_SELECTED 64
+static struct {
+	int first, last;
+} selected[MAX_SELECTED];
+static int selected_count;
+
+static int parse_ranges(const char *s)
+{
+	char *end;
+	while(*s && selected_count < MAX_SELECTED)
+	{
+		selected[selected_count].first = selected[selected_count].last = strtol(s, &end, 0);
+		if(end == s)
+			return -1;
+		if(*end == '-') {
+			s = end + 1;
+			selected[selected_count].last = strtol(s, &end, 0);
+			if(end == s)
+				return -1;
+		}
+		selected_count++;
+		s = *end == ',' ? end + 1 : end;
+		if(*end && *end != ',')
+			return -1;
+	}
+	return *s ? -1 : 0;
+}
+
+/*
+ * codepoints used in text corpus, given by -c options
+ */
+#define MAX_CODEPOINT 0x10FFFF
+static uint8_t corpus_used[(MAX_CODEPOINT >> 3) + 1];
+static int corpus_files;
+
+#define CORPUS_USED(c) ((corpus_used[(c) >> 3] >> ((c) & 7)) & 1)
+
+/*
+ * \brief mark chars of UTF-8 text as used: source file, string table, anything
+ * \return number of bytes, which are not valid UTF-8, they are skipped
+ */
+static int corpus_read(const bdf_source_t *text)
+{
+	const unsigned char *p = (const unsigned char *)text->cur, *end = (const unsigned char *)text->end;
+	int invalid = 0;
+	uint32_t c;
+
+	corpus_files++;
+	while(p < end)
+	{
+		// text is not zero terminated: sequence cut by end of file
+		if(charset_utf8_length[*p >> 4] > end - p) {
+			invalid++;
+			break;
+		}
+		c = charset_utf8_decode(&p);
+		if(c == CHARSET_INVALID || c > MAX_CODEPOINT) {
+			invalid++;
+			continue;
+		}
+		corpus_used[c >> 3] |= 1 << (c & 7);
+	}
+	return invalid;
+}
+
+static int char_selected(int c)
+{
+	int i;
+	if(selected_count == 0)
+		return c >= 0x20;
+	for(i = 0; i < selected_count; i++)
+		if(c >= selected[i].first && c <= selected[i].last)
+			return 1;
+	return 0;
+}
+
 void die(const char *reason, const char *arg)
 {
 	fprintf(stderr, reason, arg);
@@ -174,17 +688,240 @@ void die(const char *reason, const char *arg)
 	exit(1);
 }
 
+/*
+ * \brief map source file to memory, or read it whole if it can't be mapped (pipe)
+ */
+void bdf_open(bdf_source_t *src, FILE *f)
+{
+	struct stat st;
+	char *buf;
+	size_t size = 0, allocated = 1 << 16, n;
+
+	if(fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+		if(buf != MAP_FAILED) {
+			src->cur = buf;
+			src->end = buf + st.st_size;
+			return;
+		}
+	}
+	// pipe or mmap failed: read it all
+	buf = malloc(allocated);
+	while(buf != NULL && (n = fread(buf + size, 1, allocated - size, f)) > 0)
+		if((size += n) == allocated)
+			buf = realloc(buf, allocated <<= 1);
+	if(buf == NULL)
+		die("out of memory reading %s", "source");
+	src->cur = buf;
+	src->end = buf + size;
+}
+
+/*
+ * \brief dump words as C array body, n per line
+ */
+void write_words(FILE *dst, const uint32_t *w, int words, int n)
+{
+	int i;
+	for(i = 0; i < words; i++)
+		fprintf(dst, (i % n) ? " 0x%08x," : "\n\t0x%08x,", w[i]);
+}
+
+/*
+ * \brief build font pack from binary fonts, made by -f bin
+ * \param args list of name=file
+ * \return pack, allocated with malloc, or NULL
+ */
+mf_pack_t *make_pack(char **args, int count)
+{
+	mf_pack_t *pack;
+	mf_pack_entry_t *entry;
+	microfont_t *font;
+	bdf_source_t file;
+	FILE *f;
+	char *name, *file_name;
+	size_t size = sizeof(mf_pack_t) + count * sizeof(mf_pack_entry_t);
+	int i;
+
+	pack = calloc(1, size);
+	for(i = 0; i < count; i++)
+	{
+		name = args[i];
+		if((file_name = strchr(name, '=')) == NULL || file_name - name >= MF_PACK_NAME) {
+			fprintf(stderr, "Bad font '%s', must be name=file, name is up to %d chars.\n",
+				name, MF_PACK_NAME - 1);
+			return NULL;
+		}
+		*file_name++ = 0;
+		if((f = fopen(file_name, "rb")) == NULL)
+			die("unable to open font file '%s'", file_name);
+		bdf_open(&file, f);
+		font = (microfont_t *)file.cur;
+		if(file.end - file.cur < (int)sizeof(microfont_t) || font->magic != MF_MAGIC
+				|| font->version != MF_VERSION || font->size != (uint32_t)(file.end - file.cur)) {
+			fprintf(stderr, "'%s' is not a microfont v%d\n", file_name, MF_VERSION);
+			return NULL;
+		}
+		pack = realloc(pack, size + font->size);
+		entry = (mf_pack_entry_t *)mf_pack_entries(pack) + i;
+		memset(entry->name, 0, MF_PACK_NAME);
+		strcpy(entry->name, name);
+		entry->offset = size;
+		memcpy((uint8_t *)pack + size, font, font->size);
+		fprintf(stderr, "%-11s %5u bytes at %u\n", name, font->size, entry->offset);
+		size += font->size;
+	}
+	pack->magic = MF_PACK_MAGIC;
+	pack->version = MF_PACK_VERSION;
+	pack->fonts = count;
+	pack->size = size;
+	pack->checksum = mf_pack_crc(0xFFFFFFFF, (const uint32_t *)(pack + 1), (size - sizeof(mf_pack_t)) >> 2);
+	fprintf(stderr, "pack size: %u, checksum: 0x%08x\n", pack->size, pack->checksum);
+	return pack;
+}
+
+static void write_utf8(FILE *dst, int c)
+{
+	if(c < 0x80)
+		fputc(c, dst);
+	else if(c < 0x800)
+		fprintf(dst, "%c%c", 0xC0 | (c >> 6), 0x80 | (c & 0x3F));
+	else if(c < 0x10000)
+		fprintf(dst, "%c%c%c", 0xE0 | (c >> 12), 0x80 | ((c >> 6) & 0x3F), 0x80 | (c & 0x3F));
+	else
+		fprintf(dst, "%c%c%c%c", 0xF0 | (c >> 18), 0x80 | ((c >> 12) & 0x3F),
+			0x80 | ((c >> 6) & 0x3F), 0x80 | (c & 0x3F));
+}
+
+/*
+ * \brief write fixed cell font for lcd_putc(): C header with table of glyphs and charset.h
+ *        range table. glyph is bytes of 8 pixel high columns (least significant bit on top),
+ *        page by page, like display memory, so it is written to display as is.
+ *        cell is as wide as the widest char, and as high as the font, rounded up to pages.
+ *        standalone char, which looks same as one before it, takes no cell: its range points
+ *        to that one, unless duplicates are asked for
+ * \param chars sorted chars, placed to common cell
+ * \return 0 on success
+ */
+static int write_cells(FILE *dst, const char_data_t *chars, int count, const char *name,
+	const make_options_t *options)
+{
+	int i, j, x, y, width = 1, pages, size, glyphs, ranges, *glyph, fallback = -1;
+	uint8_t *cells, *cell;
+	char macro[64];
+
+	for(i = 0; i < count; i++)
+		if(chars[i].width > width)
+			width = chars[i].width;
+	pages = (chars[0].height + 7) >> 3;
+	size = width * pages;
+	cells = calloc(count, size);
+	glyph = malloc(count * sizeof(int));
+	if(cells == NULL || glyph == NULL)
+		die("out of memory making %s", "cells");
+
+	for(i = glyphs = ranges = 0; i < count; i++)
+	{
+		cell = cells + glyphs * size;
+		for(y = 0; y < chars[i].height; y++)
+			for(x = 0; x < chars[i].width; x++)
+				cell[(y >> 3) * width + x] |= CHAR_PIXEL(&chars[i], x, y) << (y & 7);
+		glyph[i] = glyphs;
+		if(i == 0 || chars[i].index != chars[i - 1].index + 1) {
+			ranges++;
+			if(!options->duplicateBitmaps && (i == count - 1 || chars[i + 1].index != chars[i].index + 1))
+				// standalone char, look for the same glyph
+				for(j = 0; j < glyphs; j++)
+					if(memcmp(cells + j * size, cell, size) == 0) {
+						glyph[i] = j;
+						memset(cell, 0, size);
+						break;
+					}
+		}
+		if(glyph[i] == glyphs)
+			glyphs++;
+		if(chars[i].index == options->fallback)
+			fallback = glyph[i];
+	}
+	if(fallback < 0) {
+		fprintf(stderr, "no fallback glyph U+%04X in font\n", options->fallback);
+		return -1;
+	}
+
+	for(i = 0; name[i] && i < (int)sizeof(macro) - 1; i++)
+		macro[i] = toupper((unsigned char)name[i]);
+	macro[i] = 0;
+	fprintf(dst,
+		"/*\n"
+		" * %s font %dx%d generated by fontconv, for lcd_putc()\n"
+		" */\n\n"
+		"#ifndef %s_H_\n"
+		"#define %s_H_\n\n"
+		"#include \"charset.h\"\n\n"
+		"#define %s_WIDTH    %d\n"
+		"#define %s_PAGES    %d\n\n"
+		"/*\n"
+		" * glyphs: columns of 8 pixels, page by page, %d chars in %d glyphs\n"
+		" */\n"
+		"const uint8_t %s[][%d] = {\n",
+		name, width, chars[0].height, macro, macro, macro, width, macro, pages, count, glyphs, name, size);
+	for(i = j = 0; i < count; i++)
+	{
+		if(glyph[i] < j)
+			continue; // standalone duplicate
+		cell = cells + j++ * size;
+		for(x = 0; x < size; x++)
+			fprintf(dst, x ? ", 0x%02X" : "\t{0x%02X", cell[x]);
+		fprintf(dst, "}, // U+%04X '", chars[i].index);
+		write_utf8(dst, chars[i].index);
+		fputs("'\n", dst);
+	}
+	fprintf(dst,
+		"};\n\n"
+		"/*\n"
+		" * Unicode to %s index mapping, sorted by codepoint\n"
+		" */\n"
+		"const glyph_range_t %s_ranges[] = {\n", name, name);
+	for(i = 0; i < count; i = j)
+	{
+		for(j = i + 1; j < count && chars[j].index == chars[j - 1].index + 1; j++)
+			;
+		fprintf(dst, "\t{0x%04X, %3d, %3d}, // '", chars[i].index, j - i, glyph[i]);
+		write_utf8(dst, chars[i].index);
+		if(j - i > 1) {
+			fputs("'..'", dst);
+			write_utf8(dst, chars[j - 1].index);
+		}
+		fputs("'\n", dst);
+	}
+	fprintf(dst,
+		"};\n\n"
+		"#define %s_RANGES   %d\n"
+		"#define %s_FALLBACK %d // shown for chars missing in font\n\n"
+		"#endif /* %s_H_ */\n",
+		macro, ranges, macro, fallback, macro);
+	free(glyph);
+	free(cells);
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
-	int i, j, k, c, mfBytes, duplicateBitmaps = 0;
-	FILE *src, *dst;
-	char *srcFileName = NULL, *dstFileName = NULL;
-	char_data_t char_data[MF_FONT_CHARS];
-	microfont_t *mf;
+	int i, k, c, count, allocated, words, cp1251 = 0, encoding = -1, order = MF_ORDER_COLUMNS;
+	int binary = 0, cells = 0, makePack = 0, all_count = 0;
+	FILE *src, *dst, *corpus;
+	char *srcFileName = NULL, *dstFileName = NULL, *fontName = NULL, *end;
+	char_data_t *char_data, *all_chars = NULL, key;
+	make_options_t options = { 0, 0, 0, 1, '?' };
+	decode_cost_t cost;
+	microfont_t *mf, *best = NULL, *whole;
+	mf_pack_t *pack;
+	const glyph_range_t *range;
+	const uint32_t *w;
+	bdf_source_t bdf, text;
 
 	opterr = 0;
 
-	while((c = getopt(argc, argv, "dhi:o:")) != -1)
+	while((c = getopt(argc, argv, "b:c:de:f:hi:m:n:o:pr:sw")) != -1)
 		switch(c)
 		{
 		case 'i':
@@ -203,17 +940,101 @@ int main(int argc, char *argv[])
 					die("unable to open destination file '%s'", optarg);
 			}
 			break;
+		case 'f':
+			if(strcmp(optarg, "bin") == 0)
+				binary = 1;
+			else if(strcmp(optarg, "cells") == 0)
+				cells = 1;
+			else if(strcmp(optarg, "c")) {
+				fprintf(stderr, "Unknown output format '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'p':
+			makePack = 1;
+			break;
+		case 'n':
+			fontName = optarg;
+			break;
+		case 'r':
+			if(parse_ranges(optarg)) {
+				fprintf(stderr, "Bad range list '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'b':
+			if(strcmp(optarg, "columns") == 0)
+				order = MF_ORDER_COLUMNS;
+			else if(strcmp(optarg, "rows") == 0)
+				order = MF_ORDER_ROWS;
+			else if(strcmp(optarg, "pages") == 0)
+				order = MF_ORDER_PAGES;
+			else {
+				fprintf(stderr, "Unknown bit order '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'e':
+			if(strcmp(optarg, "raw") == 0)
+				encoding = MF_ENCODING_RAW;
+			else if(strcmp(optarg, "rle") == 0)
+				encoding = MF_ENCODING_RLE;
+			else if(strcmp(optarg, "auto")) {
+				fprintf(stderr, "Unknown encoding '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 's':
+			options.shareBits = 1;
+			break;
+		case 'c':
+			if((corpus = fopen(optarg, "rb")) == NULL)
+				die("unable to open corpus file '%s'", optarg);
+			bdf_open(&text, corpus);
+			fclose(corpus);
+			if((k = corpus_read(&text)) > 0)
+				fprintf(stderr, "%s: %d bytes are not UTF-8, skipped\n", optarg, k);
+			break;
+		case 'm':
+			options.fallback = strtol(optarg, &end, 0);
+			if(*end) {
+				fprintf(stderr, "Bad fallback codepoint '%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'w':
+			cp1251 = 1;
+			break;
 		case 'h':
 			fputs(	"Tool for converting BDF font format to lcd_display font\n"
-					"\nUsage:\n\tfontconv -s <size> [-i <source>] [-o <destination>]\n"
+					"\nUsage:\n\tfontconv [-d] [-s] [-w] [-b <order>] [-e <encoding>] [-r <ranges>] [-n <name>] [-f <format>]\n"
+					"\t\t[-c <corpus>]... [-m <fallback>] [-i <source>] [-o <destination>]\n"
+					"\tfontconv -p [-n <name>] [-f <format>] [-o <destination>] <name>=<font> ...\n"
 					"\n\t-d\tstore bitmaps for equally looking chars.\n"
-					"\t\totherwise, store only one bitmap for such chars.\n", stderr);
+					"\t\totherwise, store only one bitmap for such chars.\n"
+					"\t-s\tshare bits between chars: char may start inside of other one,\n"
+					"\t\tor continue its end. smaller font, slow conversion.\n"
+					"\t-b\tbit order of glyphs: columns (default), rows, or pages --\n"
+					"\t\tbytes of 8 pixel high columns, like display memory, no encoding.\n"
+					"\t-e\tglyph encoding: raw, rle (run-length, Golomb-Rice coded) or auto.\n"
+					"\t\tauto is default, it takes the smallest one, with or without\n"
+					"\t\tglyph boxes (blank rows and columns around glyph aren't stored).\n"
+					"\t-w\tsource font is encoded in Windows-1251, not Unicode.\n"
+					"\t-r\tconvert only chars from list of codepoint ranges,\n"
+					"\t\tlike 0x20-0x7e,0x410-0x44f,0xb0. default is all chars from 0x20.\n"
+					"\t-c\tconvert only chars used in UTF-8 text file: sources, string tables...\n"
+					"\t\tmay be given several times. reports flash saved against whole font.\n"
+					"\t-m\tcodepoint of glyph for chars missing in font, default is 0x3f ('?').\n"
+					"\t-n\tname of font in generated source, default is mf_data.\n"
+					"\t-f\toutput format: c (default) -- C source, bin -- raw binary,\n"
+					"\t\tor cells -- C header with fixed cell font for lcd_putc().\n"
+					"\t-p\tmake font pack of fonts in bin format, for use in place from flash.\n", stderr);
 			return 1;
 		case 'd':
-			duplicateBitmaps = 1;
+			options.duplicateBitmaps = 1;
 			break;
 		case '?':
-			if(optopt == 's')
+			if(strchr("bcefimnor", optopt))
 				fprintf(stderr, "Option -%c requires an argument.\n", optopt);
 			else
 				fprintf(stderr, "Unknown option -%c.", optopt);
@@ -228,43 +1049,180 @@ int main(int argc, char *argv[])
 	if(dstFileName == NULL)
 		dst = stdout;
 
-	memset(char_data, 0, sizeof(char_data));
-	while(!feof(src))
+	if(fontName == NULL)
+		fontName = makePack ? "mf_pack" : "mf_data";
+	if(makePack) {
+		if((pack = make_pack(argv + optind, argc - optind)) == NULL)
+			return 1;
+		if(binary)
+			fwrite(pack, 1, pack->size, dst);
+		else {
+			// aligned and kept by linker, even if it is not referenced yet
+			fprintf(dst,
+				"// font pack generated by fontconv\n"
+				"#include \"microfont.h\"\n\n"
+				"const uint32_t %s_block[] __attribute__((aligned(4), used)) = {", fontName);
+			write_words(dst, (const uint32_t *)pack, pack->size / 4, 8);
+			fprintf(dst, "\n};\n\nconst mf_pack_t * const %s = (const mf_pack_t *)%s_block;\n",
+				fontName, fontName);
+		}
+		return 0;
+	}
+
+	bdf_init_tables();
+	bdf_open(&bdf, src);
+	count = 0;
+	allocated = 256;
+	char_data = malloc(allocated * sizeof(char_data_t));
+	while(1)
 	{
-		char_data_t ch;
-		if(bdf_read_char(src, &ch))
+		if(count == allocated)
+			char_data = realloc(char_data, (allocated <<= 1) * sizeof(char_data_t));
+		if(char_data == NULL)
+			die("out of memory reading %s", "glyphs");
+		if((k = bdf_read_char(&bdf, &char_data[count])) < 0)
 			break;
-		if(ch.index < 32 || ch.index > 255) {
-			fprintf(stderr, "char #%02x out of range, skipping.\n", ch.index);
+		if(k > 0) {
+			fprintf(stderr, "char #%02x is too big or not encoded, skipping.\n", char_data[count].index);
 			continue;
 		}
-//		fprintf(stderr, "char #%02x read ok.\n", ch.index);
-		char_data[ch.index - 32] = ch;
+		// font made in Windows-1251: encodings above 0xFF are Unicode already
+		if(cp1251 && char_data[count].index <= 0xFF)
+			char_data[count].index = charset_cp1251_decode(char_data[count].index);
+		if(!char_selected(char_data[count].index))
+			continue;
+		count++;
+	}
+	if(count == 0) {
+		fprintf(stderr, "no chars to convert\n");
+		return 1;
 	}
 
-	mf = (microfont_t *)malloc(sizeof(microfont_t) + MF_MAX_FONT_DATA);
-	mfBytes = make_microfont(char_data, mf, duplicateBitmaps);
-	fprintf(stderr, "microfont size: %d\n", sizeof(microfont_t) + mfBytes);
-	
-	fprintf(dst,
-		"// microfont generated from %s\n"
-		"#include \"microfont.h\"\n\n"
-		"microfont_t mf_data = {\n"
-		"\t0xface, %d, %d,\n\t{", srcFileName, mf->height, mf->widthbits);
-	for(i = 0; i < MF_FONT_CHARS - 1; i++)
+	// range table needs sorted codepoints. for duplicates, the last one wins
+	qsort(char_data, count, sizeof(char_data_t), char_index_cmp);
+	for(i = k = 0; i < count; i++)
 	{
-		if((i & 7) == 0)
-			fprintf(dst, "\n\t\t");
-		fprintf(dst, "0x%04x, ", mf->index[i]);
+		if(k > 0 && char_data[k - 1].index == char_data[i].index)
+			k--;
+		char_data[k++] = char_data[i];
 	}
-	fprintf(dst, "0x%04x\n\t},\n\t{\n\t\t", mf->index[MF_FONT_CHARS - 1]);
-	for(i = 0; i < (mfBytes >> 2) - 1; i++)
-	{
-		fprintf(dst, "0x%08x /* %4d */, ", mf->bits[i], i << 5);
-		if((i % 5) == 4)
-			fprintf(dst, "\n\t\t");
+	count = k;
+
+	if(corpus_files) {
+		// keep whole font to compare with, take only chars from corpus, and fallback
+		all_chars = char_data;
+		all_count = count;
+		char_data = malloc(count * sizeof(char_data_t));
+		for(i = k = 0; i < all_count; i++)
+			if(CORPUS_USED(all_chars[i].index) || all_chars[i].index == options.fallback)
+				char_data[k++] = all_chars[i];
+		count = k;
+		for(key.index = 0x20, k = 0; key.index <= MAX_CODEPOINT; key.index++)
+			if(CORPUS_USED(key.index) && char_selected(key.index)
+				&& bsearch(&key, char_data, count, sizeof(char_data_t), char_index_cmp) == NULL) {
+				if(k++ < 16)
+					fprintf(stderr, "U+%04X is used, but it isn't in font\n", key.index);
+			}
+		fprintf(stderr, "corpus: %d of %d chars of font are used, %d used chars are missing\n",
+			count, all_count, k);
+		if(count == 0) {
+			fprintf(stderr, "no chars to convert\n");
+			return 1;
+		}
+	}
+
+	if(order == MF_ORDER_PAGES && encoding == MF_ENCODING_RLE) {
+		fprintf(stderr, "Page order can't be run-length coded.\n");
+		return 1;
+	}
+	if(order == MF_ORDER_PAGES)
+		encoding = MF_ENCODING_RAW;
+
+	if(place_chars(char_data, count) == 0) {
+		fprintf(stderr, "chars don't fit to %d pixels high cell\n", MF_MAX_FONT_H);
+		return 1;
 	}
-	fprintf(dst, "0x%08x\n\t}\n};\n", mf->bits[(mfBytes >> 2) - 1]);
-	
+	if(cells)
+		return write_cells(dst, char_data, count, fontName, &options) != 0;
+
+	// try encodings, with and without boxes, report flash/CPU trade-off, take the smallest font
+	fprintf(stderr, "encoding       size  worst cycles/glyph  average\n");
+	for(i = 0; i < (order == MF_ORDER_PAGES ? 1 : 2); i++)
+		for(c = MF_ENCODING_RAW; c <= MF_ENCODING_RLE; c++)
+			for(k = 0; k < (c == MF_ENCODING_RLE ? 8 : 1); k++)
+			{
+				if(encoding >= 0 && encoding != c)
+					continue;
+				options.flags = c | order | (k << MF_FLAG_RICE_K_SHIFT) | (i ? MF_FLAG_BOX : 0);
+				if(c)
+					fprintf(stderr, "rle, k=%d %s", k, i ? "box " : "    ");
+				else
+					fprintf(stderr, "raw       %s", i ? "box " : "    ");
+				if((mf = make_microfont(char_data, count, &options, &cost)) == NULL) {
+					fprintf(stderr, "won't fit\n");
+					continue;
+				}
+				fprintf(stderr, "%5u  %8u (U+%04X)  %7u\n",
+					mf->size, cost.worst_cycles, cost.worst_index, cost.total_cycles / cost.glyphs);
+				if(best == NULL || mf->size < best->size) {
+					free(best);
+					best = mf;
+				}
+				else
+					free(mf);
+			}
+	if(best == NULL)
+		return 1;
+
+	// build it once more, reporting every glyph
+	options.flags = best->flags;
+	options.quiet = 0;
+	free(best);
+	mf = make_microfont(char_data, count, &options, &cost);
+	fprintf(stderr, "microfont size: %u, encoding: %s, k=%d%s\n", mf->size,
+		(mf->flags & MF_FLAG_ENCODING) == MF_ENCODING_RLE ? "rle" : "raw",
+		(mf->flags & MF_FLAG_RICE_K) >> MF_FLAG_RICE_K_SHIFT, (mf->flags & MF_FLAG_BOX) ? ", boxes" : "");
+	if(all_chars != NULL) {
+		// whole font in the same encoding, to see how much flash corpus saves
+		options.quiet = 1;
+		if(place_chars(all_chars, all_count) == 0
+			|| (whole = make_microfont(all_chars, all_count, &options, &cost)) == NULL)
+			fprintf(stderr, "whole font doesn't fit to microfont at all\n");
+		else {
+			fprintf(stderr, "whole font size: %u, saved %d bytes of flash (%d%%)\n", whole->size,
+				(int)(whole->size - mf->size), (int)(100 - 100LL * mf->size / whole->size));
+			free(whole);
+		}
+	}
+
+	if(binary) {
+		fwrite(mf, 1, mf->size, dst);
+		return 0;
+	}
+
+	// font block is dumped as words, so it is 4-byte aligned and can be used right from flash
+	w = (const uint32_t *)mf;
+	fprintf(dst,
+		"// microfont generated from %s\n"
+		"#include \"microfont.h\"\n\n"
+		"static const uint32_t %s_block[] = {\n"
+		"\t// magic, version, flags, height, widthbits, ranges, glyphs, fallback, size\n"
+		"\t0x%08x, 0x%08x, 0x%08x, 0x%08x,\n"
+		"\t// ranges: first codepoint, count | base << 16\n",
+		srcFileName, fontName, w[0], w[1], w[2], w[3]);
+	words = sizeof(microfont_t) / 4;
+	range = mf_ranges(mf);
+	for(i = 0; i < mf->ranges; i++, words += 2)
+		fprintf(dst, "\t0x%08x, 0x%08x, // U+%04X..U+%04X\n",
+			w[words], w[words + 1], range[i].first, range[i].first + range[i].count - 1);
+	fprintf(dst, "\t// offsets of glyphs in bits, two per word");
+	write_words(dst, w + words, (mf->glyphs + 1) / 2, 8);
+	words += (mf->glyphs + 1) / 2;
+	fprintf(dst, "\n\t// bits");
+	for(i = 0; words < (int)(mf->size / 4); i++, words++)
+		fprintf(dst, (i % 5) ? " 0x%08x /* %5d */," : "\n\t0x%08x /* %5d */,", w[words], i << 5);
+	fprintf(dst, "\n};\n\nconst microfont_t * const %s = (const microfont_t *)%s_block;\n",
+		fontName, fontName);
+
 	return 0;
 }
@@ -1,7 +1,68 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "microfont.h"
 
-void main(void)
+/*
+ * two ranges: 'A'..'C' with 'B' missing, and U+0410, fallback is 'A'
+ */
+static const uint32_t test_block[] = {
+	0x0002face, 0x00020108, 0x00000004, 0x0000002c,
+	0x00000041, 0x00000003,
+	0x00000410, 0x00030001,
+	0xffff0000, 0x00200010,
+	0x00000000
+};
+
+/*
+ * 'A' only, 2x4, RLE with k=1: columns 0011 and 1000, runs are 2 white, 3 black, 3 white
+ */
+static const uint32_t rle_block[] = {
+	0x1102face, 0x00010104, 0xffff0001, 0x00000024,
+	0x00000041, 0x00000001,
+	0x00000000,
+	0x000002d3, 0x00000000
+};
+
+static int test_rle(void)
 {
-	printf("sizeof(microfont_t) = %d\n", sizeof(microfont_t));
+	static const uint8_t pixels[] = { 0, 0, 1, 1, 1, 0, 0, 0 };
+	mf_reader_t reader;
+	int i, failures = 0;
+	// loaded font gets exactly font->size bytes, decoder must stay inside
+	microfont_t *font = malloc(((const microfont_t *)rle_block)->size);
+
+	memcpy(font, rle_block, ((const microfont_t *)rle_block)->size);
+	failures += mf_read_init(&reader, font, mf_find_glyph(font, 'A')) != 2;
+	for(i = 0; i < 8; i++)
+		failures += mf_read_pixel(&reader) != pixels[i];
+	failures += reader.bs.offset != 10;
+	free(font);
+	return failures;
+}
+
+int main(void)
+{
+	const microfont_t *font = (const microfont_t *)test_block;
+	int failures = 0;
+
+	printf("sizeof(microfont_t) = %d, sizeof(glyph_range_t) = %d\n",
+		(int)sizeof(microfont_t), (int)sizeof(glyph_range_t));
+	failures += sizeof(microfont_t) != 16 || sizeof(glyph_range_t) != 8;
+	failures += font->magic != MF_MAGIC || font->version != MF_VERSION || font->size != sizeof(test_block);
+	failures += mf_bits(font) != test_block + 10;
+	failures += mf_find_glyph(font, 'A') != 0;
+	failures += mf_find_glyph(font, 'C') != 16;
+	failures += mf_find_glyph(font, 0x410) != 32;
+	// missing chars, inside and outside of ranges
+	failures += mf_find_glyph(font, 'B') != 0;
+	failures += mf_find_glyph(font, 0x20) != 0;
+	failures += mf_find_glyph(font, 0x411) != 0;
+	failures += mf_find_glyph(font, 0x10FFFF) != 0;
+	failures += test_rle();
+	// CRC unit of STM32 gives this for single word
+	failures += mf_pack_crc(0xFFFFFFFF, (const uint32_t []){ 0x12345678 }, 1) != 0xDF8A8A2B;
+	failures += sizeof(mf_pack_t) != 16 || sizeof(mf_pack_entry_t) != 16;
+	printf(failures ? "FAILED\n" : "ok\n");
+	return failures != 0;
 }
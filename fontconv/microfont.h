@@ -3,31 +3,243 @@
 
 #include <stdint.h>
 
+#include "bitstream.h"
+#include "charset.h"
+
 /*
- *	Формат для хранения шрифта:
+ *	Формат для хранения шрифта, версия 2:
+ *	шрифт -- один непрерывный блок, выровненный на 4 байта, без указателей,
+ *	поэтому может использоваться прямо из флеша.
+ *	* Состав блока
+ *	microfont_t           заголовок
+ *	glyph_range_t[ranges] диапазоны кодов Unicode, отсортированные по first (charset.h),
+ *	                      base -- индекс первого кода в таблице смещений
+ *	uint16_t[glyphs]      смещения знаков в битах, дополняется до 4 байт
+ *	uint32_t[]            битовый массив и еще одно слово, чтобы читать по два слова
+ *	* Знак в битовом массиве
+ *	ширина-1 (widthbits бит), затем пикселы в порядке MF_FLAG_ORDER,
+ *	как есть или сжатые (см. MF_FLAG_ENCODING)
+ *	* Знак с рамкой (MF_FLAG_BOX)
+ *	хранятся только пикселы внутри рамки, пустые строки и столбцы вокруг отброшены:
+ *	ширина ячейки-1 (widthbits), x рамки (widthbits), y рамки от верха ячейки (mf_ybits()),
+ *	высота рамки (mf_ybits()), если она не 0 -- ширина рамки-1 (widthbits), затем пикселы рамки.
+ *	Ячейка у всех знаков одной высоты, базовая линия на одной строке, так что
+ *	выравнивание по базовой линии сохраняется.
  *	* Ограничения
- *	Первый знак -- всегда 0x20 (пробел)
- *	Последний знак -- всегда 0xFF ("я")
- *  Кодировка -- всегда Windows-1251
  *	Ширина -- до 32 пикселов
  *	Высота -- до 64 пикселов
- *	Размер данных -- до 8кбайт (64 кбит, адресуются uint32_t)
+ *	Размер данных -- до 8кбайт (64 кбит, адресуются uint16_t)
  */
 
+#define MF_MAGIC         0xface
+#define MF_VERSION       2
 #define MF_MAX_FONT_W    32
 #define MF_MAX_FONT_H    64
-#define MF_FIRST_CHAR    32
-#define MF_LAST_CHAR     255
-#define MF_FONT_CHARS    (MF_LAST_CHAR - MF_FIRST_CHAR + 1)
 #define MF_MAX_FONT_DATA 8192
-#define MF_EMPTY_CHAR    65535
+#define MF_EMPTY_CHAR    65535 // в таблице смещений: знака нет
+#define MF_NO_GLYPH      65535 // в поле fallback: замены нет
+
+// флаги
+#define MF_FLAG_ENCODING 0x03  // маска: способ кодирования пикселов
+#define MF_ENCODING_RAW  0x00  // бит на пиксел
+#define MF_ENCODING_RLE  0x01  // чередующиеся серии белых и черных пикселов, код Голомба-Райса
+#define MF_FLAG_ORDER    0x0C  // маска: порядок пикселов
+#define MF_ORDER_COLUMNS 0x00  // по столбцам, сверху вниз
+#define MF_ORDER_ROWS    0x04  // по строкам, слева направо
+#define MF_ORDER_PAGES   0x08  // байты столбцов по 8 пикселов (младший бит сверху), как в памяти
+                               // дисплея: сначала все столбцы первой страницы, потом второй...
+                               // только без сжатия, widthbits = 8, все знаки выровнены на байт
+#define MF_FLAG_RICE_K   0x70  // маска: параметр k кода Райса
+#define MF_FLAG_RICE_K_SHIFT 4
+#define MF_FLAG_BOX      0x80  // у знаков есть рамка, кроме страничного порядка
 
 typedef struct {
 	uint16_t magic;                // 0xface
+	uint8_t  version;              // MF_VERSION
+	uint8_t  flags;                // MF_FLAG_*
 	uint8_t  height;               // высота шрифта
 	uint8_t  widthbits;            // количество бит, отведенных под ширину
-	uint16_t index[MF_FONT_CHARS]; // массив смещений в битах
-	uint32_t bits[];               // битовый массив
+	uint16_t ranges;               // количество диапазонов
+	uint16_t glyphs;               // размер таблицы смещений
+	uint16_t fallback;             // индекс знака для отсутствующих кодов, или MF_NO_GLYPH
+	uint32_t size;                 // размер всего блока в байтах
 } microfont_t;
 
+static inline const glyph_range_t *mf_ranges(const microfont_t *font)
+{
+	return (const glyph_range_t *)(font + 1);
+}
+
+static inline const uint16_t *mf_offsets(const microfont_t *font)
+{
+	return (const uint16_t *)(mf_ranges(font) + font->ranges);
+}
+
+static inline const uint32_t *mf_bits(const microfont_t *font)
+{
+	return (const uint32_t *)(mf_offsets(font) + ((font->glyphs + 1) & ~1));
+}
+
+/*
+ *	Количество бит для y и высоты рамки: чтобы вместилось число height
+ */
+static inline int mf_ybits(const microfont_t *font)
+{
+	int bits = 0;
+	while(font->height >> bits)
+		bits++;
+	return bits;
+}
+
+/*
+ *	Поиск знака по диапазонам, тем же charset_find_glyph(), что и у шрифта 6x8.
+ *	Возвращает смещение знака в битах, или MF_EMPTY_CHAR, если знака нет и замены тоже нет.
+ */
+static inline uint16_t mf_find_glyph(const microfont_t *font, uint32_t c)
+{
+	int index = charset_find_glyph(mf_ranges(font), font->ranges, c);
+	uint16_t offset;
+
+	if(index >= 0 && (offset = mf_offsets(font)[index]) != MF_EMPTY_CHAR)
+		return offset;
+	return font->fallback == MF_NO_GLYPH ? MF_EMPTY_CHAR : mf_offsets(font)[font->fallback];
+}
+
+/*
+ *	Чтение пикселов знака.
+ *	RLE: серии чередуются, начиная с белой (она может быть пустой), и не прерываются
+ *	на границе столбцов. Длина серии n: n >> k единиц, ноль, затем младшие k бит n.
+ *
+ *	Цена декодирования на Cortex-M0 (оценка по числу инструкций, не измерение):
+ *	бит потока ~8 тактов, начало серии ~10 тактов, вывод пиксела в буфер кадра ~12 тактов.
+ *	RAW: знак из P пикселов -- 20*P тактов.
+ *	RLE: знак длиной L бит из R серий -- 8*L + 10*R + 12*P тактов. Худший случай --
+ *	чередование пикселов: R = P, L = (k+1)*P, при k=0 это 38*P тактов, вдвое дольше RAW.
+ *	PAGES: копирование ~8 тактов на байт, то есть ~1 такт на пиксел.
+ *	С рамкой P -- пикселы рамки, плюс очистка ячейки ~8 тактов на байт.
+ *	fontconv считает худший знак шрифта по этой формуле и печатает его.
+ */
+typedef struct {
+	bs_reader_t bs;
+	uint32_t run;                  // осталось пикселов в текущей серии
+	uint8_t  color;                // цвет текущей серии
+	uint8_t  encoding;
+	uint8_t  k;
+	uint8_t  box_x, box_y;         // рамка внутри ячейки знака
+	uint8_t  box_width, box_height;
+} mf_reader_t;
+
+static inline uint32_t mf_read_rice(mf_reader_t *r)
+{
+	uint32_t n = 0;
+	while(bs_read_bit(&r->bs))
+		n++;
+	return r->k ? (n << r->k) | bs_read_bits(&r->bs, r->k) : n;
+}
+
+/*
+ *	Начать чтение знака. Возвращает ширину ячейки знака, рамка -- в r->box_*.
+ *	Без MF_FLAG_BOX рамка совпадает с ячейкой.
+ */
+static inline int mf_read_init(mf_reader_t *r, const microfont_t *font, uint16_t offset)
+{
+	int width, ybits;
+
+	bs_reader_init(&r->bs, mf_bits(font), offset);
+	r->run = 0;
+	r->color = 1; // первая серия -- белая
+	r->encoding = font->flags & MF_FLAG_ENCODING;
+	r->k = (font->flags & MF_FLAG_RICE_K) >> MF_FLAG_RICE_K_SHIFT;
+	// ширина хранится уменьшенной на 1
+	width = bs_read_bits(&r->bs, font->widthbits) + 1;
+	if(!(font->flags & MF_FLAG_BOX)) {
+		r->box_x = r->box_y = 0;
+		r->box_width = width;
+		r->box_height = font->height;
+		return width;
+	}
+	ybits = mf_ybits(font);
+	r->box_x = bs_read_bits(&r->bs, font->widthbits);
+	r->box_y = bs_read_bits(&r->bs, ybits);
+	r->box_height = bs_read_bits(&r->bs, ybits);
+	r->box_width = r->box_height ? bs_read_bits(&r->bs, font->widthbits) + 1 : 0;
+	return width;
+}
+
+/*
+ *	Следующий пиксел рамки знака, в порядке MF_FLAG_ORDER
+ */
+static inline uint32_t mf_read_pixel(mf_reader_t *r)
+{
+	if(r->encoding == MF_ENCODING_RAW)
+		return bs_read_bit(&r->bs);
+	while(r->run == 0)
+	{
+		r->color ^= 1;
+		r->run = mf_read_rice(r);
+	}
+	r->run--;
+	return r->color;
+}
+
+/*
+ *	Байты знака в порядке MF_ORDER_PAGES, после mf_read_init().
+ *	Битовый массив заполняется с младших битов, поэтому на little-endian процессоре
+ *	(Cortex-M, x86) байт с битовым смещением 8*n -- это просто n-й байт массива.
+ */
+static inline const uint8_t *mf_read_pages(const mf_reader_t *r)
+{
+	return (const uint8_t *)r->bs.data + (r->bs.offset >> 3);
+}
+
+/*
+ *	Набор шрифтов (font pack) -- для прошивки отдельно от программы.
+ *	mf_pack_t                 заголовок
+ *	mf_pack_entry_t[fonts]    описатели шрифтов
+ *	microfont_t...            шрифты, каждый выровнен на 4 байта
+ *	Контрольная сумма -- CRC-32 всего, что после заголовка, по словам, как считает
+ *	блок CRC в STM32: полином 0x04C11DB7, начальное значение 0xFFFFFFFF, старшие биты слова первыми.
+ */
+
+#define MF_PACK_MAGIC    0x6b70666d // "mfpk"
+#define MF_PACK_VERSION  1
+#define MF_PACK_NAME     12
+
+typedef struct {
+	uint32_t magic;                // MF_PACK_MAGIC
+	uint16_t version;              // MF_PACK_VERSION
+	uint16_t fonts;                // количество шрифтов
+	uint32_t size;                 // размер набора в байтах
+	uint32_t checksum;             // CRC-32 после заголовка
+} mf_pack_t;
+
+typedef struct {
+	char     name[MF_PACK_NAME];   // имя шрифта, дополняется нулями
+	uint32_t offset;               // от начала набора, кратно 4
+} mf_pack_entry_t;
+
+static inline const mf_pack_entry_t *mf_pack_entries(const mf_pack_t *pack)
+{
+	return (const mf_pack_entry_t *)(pack + 1);
+}
+
+/*
+ *	CRC-32 как у STM32, программная, по 4 бита за шаг
+ */
+static inline uint32_t mf_pack_crc(uint32_t crc, const uint32_t *data, uint32_t words)
+{
+	static const uint32_t table[16] = {
+		0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+		0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+	};
+	int i;
+	while(words--)
+	{
+		crc ^= *data++;
+		for(i = 0; i < 8; i++)
+			crc = (crc << 4) ^ table[crc >> 28];
+	}
+	return crc;
+}
+
 #endif // _MICROFONT_H
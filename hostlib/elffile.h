@@ -0,0 +1,197 @@
+/*
+ * elffile.h
+ *
+ *  Reading firmware ELF files for host tools (logdecode, pcprof): sections and symbols of
+ *  32 or 64 bit little-endian files, in one form for both classes. Header only, all functions
+ *  are static inline, so each tool still builds from its single source file:
+ *
+ *  #include "../hostlib/elffile.h"
+ */
+
+#ifndef ELFFILE_H_
+#define ELFFILE_H_
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	const char *name;
+	uint32_t    type;             // SHT_*
+	uint32_t    link;             // for SHT_SYMTAB: index of its string table
+	uint64_t    addr, offset, size;
+} elf_section_t;
+
+typedef struct {
+	const char *name;
+	uint64_t    value, size;
+	int         type;             // STT_*
+} elf_symbol_t;
+
+typedef struct {
+	unsigned char *data;
+	long           size;
+	int            is64;
+	int            machine;       // EM_*
+	int            sections;
+	elf_section_t *section;
+} elf_file_t;
+
+static inline void die(const char *reason, const char *arg)
+{
+	fprintf(stderr, reason, arg);
+	fputs(": ", stderr);
+	perror(NULL);
+	exit(1);
+}
+
+/*
+ * \brief whole file to memory, dies if it can't be read
+ */
+static inline unsigned char *read_file(const char *file_name, long *size)
+{
+	FILE *f;
+	unsigned char *data;
+
+	if((f = fopen(file_name, "rb")) == NULL)
+		die("unable to open '%s'", file_name);
+	fseek(f, 0, SEEK_END);
+	*size = ftell(f);
+	rewind(f);
+	if((data = malloc(*size + 1)) == NULL || fread(data, 1, *size, f) != (size_t)*size)
+		die("unable to read '%s'", file_name);
+	fclose(f);
+	return data;
+}
+
+static inline int elf_in_file(const elf_file_t *elf, uint64_t offset, uint64_t size)
+{
+	return offset <= (uint64_t)elf->size && size <= (uint64_t)elf->size - offset;
+}
+
+/*
+ * \brief section header i in class-independent form
+ * \return offset of its name in section of names
+ */
+static inline uint32_t elf_read_section(const elf_file_t *elf, uint64_t shoff, int i, elf_section_t *s)
+{
+	if(elf->is64) {
+		const Elf64_Shdr *h = (const Elf64_Shdr *)(elf->data + shoff) + i;
+		s->type = h->sh_type, s->link = h->sh_link;
+		s->addr = h->sh_addr, s->offset = h->sh_offset, s->size = h->sh_size;
+		return h->sh_name;
+	}
+	else {
+		const Elf32_Shdr *h = (const Elf32_Shdr *)(elf->data + shoff) + i;
+		s->type = h->sh_type, s->link = h->sh_link;
+		s->addr = h->sh_addr, s->offset = h->sh_offset, s->size = h->sh_size;
+		return h->sh_name;
+	}
+}
+
+/*
+ * \brief read ELF file and its section headers
+ * \return 0 on success, -1 if file is not a little-endian ELF or is broken
+ */
+static inline int elf_open(elf_file_t *elf, const char *file_name)
+{
+	const unsigned char *d;
+	elf_section_t names;
+	uint64_t shoff;
+	uint32_t name;
+	int i, shentsize, shstrndx;
+
+	d = elf->data = read_file(file_name, &elf->size);
+	if(elf->size < (long)sizeof(Elf64_Ehdr) || memcmp(d, ELFMAG, SELFMAG) || d[EI_DATA] != ELFDATA2LSB
+			|| (d[EI_CLASS] != ELFCLASS32 && d[EI_CLASS] != ELFCLASS64))
+		return -1;
+	elf->is64 = d[EI_CLASS] == ELFCLASS64;
+	if(elf->is64) {
+		const Elf64_Ehdr *h = (const Elf64_Ehdr *)d;
+		elf->machine = h->e_machine;
+		elf->sections = h->e_shnum;
+		shoff = h->e_shoff;
+		shstrndx = h->e_shstrndx;
+		shentsize = sizeof(Elf64_Shdr);
+	}
+	else {
+		const Elf32_Ehdr *h = (const Elf32_Ehdr *)d;
+		elf->machine = h->e_machine;
+		elf->sections = h->e_shnum;
+		shoff = h->e_shoff;
+		shstrndx = h->e_shstrndx;
+		shentsize = sizeof(Elf32_Shdr);
+	}
+	if(!elf_in_file(elf, shoff, (uint64_t)elf->sections * shentsize) || shstrndx >= elf->sections)
+		return -1;
+	elf_read_section(elf, shoff, shstrndx, &names);
+	if(!elf_in_file(elf, names.offset, names.size))
+		return -1;
+
+	elf->section = calloc(elf->sections, sizeof(elf_section_t));
+	for(i = 0; i < elf->sections; i++)
+	{
+		name = elf_read_section(elf, shoff, i, &elf->section[i]);
+		elf->section[i].name = name < names.size ? (const char *)d + names.offset + name : "";
+	}
+	return 0;
+}
+
+/*
+ * \return section or NULL, if there is no section of that name or it doesn't fit in file
+ */
+static inline const elf_section_t *elf_find_section(const elf_file_t *elf, const char *name)
+{
+	int i;
+
+	for(i = 0; i < elf->sections; i++)
+		if(strcmp(elf->section[i].name, name) == 0)
+			return elf_in_file(elf, elf->section[i].offset, elf->section[i].size) ? &elf->section[i] : NULL;
+	return NULL;
+}
+
+/*
+ * \brief call fn for every symbol of every symbol table
+ * \return number of symbols
+ */
+static inline int elf_symbols(const elf_file_t *elf, void (*fn)(const elf_symbol_t *sym, void *arg), void *arg)
+{
+	int i, count = 0;
+	uint64_t j, entsize = elf->is64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+	elf_symbol_t sym;
+
+	for(i = 0; i < elf->sections; i++)
+	{
+		const elf_section_t *s = &elf->section[i], *strtab;
+		const unsigned char *p = elf->data + s->offset;
+		uint32_t name;
+		if(s->type != SHT_SYMTAB || s->link >= (uint32_t)elf->sections || !elf_in_file(elf, s->offset, s->size))
+			continue;
+		strtab = &elf->section[s->link];
+		if(!elf_in_file(elf, strtab->offset, strtab->size))
+			continue;
+		for(j = 0; j < s->size / entsize; j++, p += entsize)
+		{
+			if(elf->is64) {
+				const Elf64_Sym *e = (const Elf64_Sym *)p;
+				name = e->st_name, sym.value = e->st_value, sym.size = e->st_size;
+				sym.type = ELF64_ST_TYPE(e->st_info);
+			}
+			else {
+				const Elf32_Sym *e = (const Elf32_Sym *)p;
+				name = e->st_name, sym.value = e->st_value, sym.size = e->st_size;
+				sym.type = ELF32_ST_TYPE(e->st_info);
+			}
+			if(name >= strtab->size)
+				continue;
+			sym.name = (const char *)elf->data + strtab->offset + name;
+			fn(&sym, arg);
+			count++;
+		}
+	}
+	return count;
+}
+
+#endif /* ELFFILE_H_ */
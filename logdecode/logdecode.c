@@ -0,0 +1,168 @@
+/*
+ * logdecode.c
+ *
+ *  Host side of binary logging (stm32_dht22/src/log.h): reads format strings from .logstr
+ *  section of firmware ELF and prints log stream (USART capture, RTT dump...) as text.
+ *  Bytes outside of records are trace_printf() text, they are copied as is.
+ *
+ *  gcc -O2 -Wall logdecode.c -o logdecode
+ *  logdecode <firmware.elf> [<stream>]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../hostlib/elffile.h"
+
+#define LOG_MARKER   0xFF
+#define LOG_MAX_ARGS 8
+
+/*
+ * format strings, as they are in firmware address space
+ */
+static char    *strings;
+static uint32_t strings_addr, strings_size;
+
+/*
+ * \brief load .logstr section of ELF file, 32 or 64 bit, little-endian
+ * \return 0 on success
+ */
+static int load_strings(const char *file_name)
+{
+	elf_file_t elf;
+	const elf_section_t *s;
+
+	if(elf_open(&elf, file_name))
+		return -1;
+	if((s = elf_find_section(&elf, ".logstr")) == NULL) {
+		fprintf(stderr, "no .logstr section in '%s'\n", file_name);
+		return -1;
+	}
+	strings_addr = s->addr;
+	strings_size = s->size;
+	// terminated, even if the last string is broken
+	strings = calloc(1, strings_size + 1);
+	memcpy(strings, elf.data + s->offset, strings_size);
+	free(elf.section);
+	free(elf.data);
+	return 0;
+}
+
+/*
+ * \brief printf() with 32-bit integer arguments only, like firmware passes them
+ */
+static void print_record(FILE *dst, const char *format, const uint32_t *args, int count)
+{
+	char spec[32];
+	const char *p;
+	int n, used = 0;
+
+	for(p = format; *p; p++)
+	{
+		if(*p != '%') {
+			fputc(*p, dst);
+			continue;
+		}
+		// flags, width, precision; length modifiers are dropped
+		spec[0] = '%';
+		for(n = 1, p++; *p && strchr("-+ #0123456789.", *p) && n < (int)sizeof(spec) - 2; p++)
+			spec[n++] = *p;
+		while(*p && strchr("hlLqjzt", *p))
+			p++;
+		if(*p == 0)
+			break;
+		if(*p == '%') {
+			fputc('%', dst);
+			continue;
+		}
+		if(used == count) {
+			fputs("<missing>", dst);
+			continue;
+		}
+		spec[n++] = *p;
+		spec[n] = 0;
+		switch(*p)
+		{
+		case 'd':
+		case 'i':
+			fprintf(dst, spec, (int)(int32_t)args[used++]);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'c':
+			fprintf(dst, spec, (unsigned)args[used++]);
+			break;
+		case 'p':
+			fprintf(dst, "0x%08x", (unsigned)args[used++]);
+			break;
+		default:
+			// %s and floats can't be logged: the word is all we have
+			fprintf(dst, "<%%%c:0x%08x>", *p, (unsigned)args[used++]);
+		}
+	}
+}
+
+/*
+ * \brief read little-endian words
+ * \return 0 if stream ended
+ */
+static int read_words(FILE *src, uint32_t *words, int count)
+{
+	unsigned char b[4];
+	int i;
+
+	for(i = 0; i < count; i++)
+	{
+		if(fread(b, 1, 4, src) != 4)
+			return 0;
+		words[i] = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+	}
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *src = stdin;
+	uint32_t header, args[LOG_MAX_ARGS];
+	unsigned char b[3];
+	int c, count;
+
+	if(argc < 2 || argc > 3) {
+		fputs(	"Decoder of binary log, written by LOG() of stm32_dht22/src/log.h\n"
+				"\nUsage:\n\tlogdecode <firmware.elf> [<stream>]\n"
+				"\n\tstream is read from standard input, if no file given.\n", stderr);
+		return 1;
+	}
+	if(load_strings(argv[1])) {
+		fprintf(stderr, "'%s' is not a little-endian ELF file with format strings\n", argv[1]);
+		return 1;
+	}
+	if(argc == 3 && (src = fopen(argv[2], "rb")) == NULL)
+		die("unable to open stream '%s'", argv[2]);
+	// messages come as they are logged, show them at once
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	while((c = getc(src)) != EOF)
+	{
+		if(c != LOG_MARKER) {
+			putchar(c);
+			continue;
+		}
+		if(fread(b, 1, 3, src) != 3)
+			break;
+		header = LOG_MARKER | (b[0] << 8) | (b[1] << 16) | ((uint32_t)b[2] << 24);
+		count = (header >> 8) & 0x0F;
+		if(count > LOG_MAX_ARGS || (header >> 12) - strings_addr >= strings_size) {
+			printf("<bad record 0x%08x>\n", (unsigned)header);
+			continue;
+		}
+		if(!read_words(src, args, count))
+			break;
+		print_record(stdout, strings + ((header >> 12) - strings_addr), args, count);
+	}
+	return 0;
+}
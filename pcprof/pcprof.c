@@ -0,0 +1,172 @@
+/*
+ * pcprof.c
+ *
+ *  Host side of statistical profiler (stm32_dht22/src/pcsample.h): maps histogram of sampled
+ *  program counters to functions of firmware ELF file and prints flat profile.
+ *  Histogram is found in dump by its magic, so dump of pcsample variable or of the whole RAM
+ *  will do. Bucket spanning several functions is shared between them by bytes.
+ *
+ *  gcc -O2 -Wall pcprof.c -o pcprof
+ *  pcprof <firmware.elf> <dump>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../hostlib/elffile.h"
+
+#define PCSAMPLE_MAGIC  0x6d736370
+#define PCSAMPLE_HEADER 24 // bytes before counts
+
+typedef struct {
+	const char *name;
+	uint32_t addr, size;
+	double samples;
+} symbol_t;
+
+static symbol_t *symbols;
+static int symbol_count;
+
+/*
+ * elf_symbols() callback: functions of known size
+ */
+static void add_symbol(const elf_symbol_t *sym, void *thumb)
+{
+	if(sym->type != STT_FUNC || sym->size == 0)
+		return;
+	symbols = realloc(symbols, (symbol_count + 1) * sizeof(symbol_t));
+	symbols[symbol_count].name = sym->name;
+	// Thumb function addresses have bit 0 set
+	symbols[symbol_count].addr = *(int *)thumb ? sym->value & ~1 : sym->value;
+	symbols[symbol_count].size = sym->size;
+	symbols[symbol_count].samples = 0;
+	symbol_count++;
+}
+
+static int by_address(const void *a, const void *b)
+{
+	const symbol_t *x = a, *y = b;
+	return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+static int by_samples(const void *a, const void *b)
+{
+	const symbol_t *x = a, *y = b;
+	return x->samples > y->samples ? -1 : x->samples < y->samples;
+}
+
+/*
+ * \brief load function symbols of ELF file, 32 or 64 bit, little-endian
+ * \return 0 on success
+ */
+static int load_symbols(const char *file_name)
+{
+	elf_file_t elf;
+	int i, j, thumb;
+
+	if(elf_open(&elf, file_name))
+		return -1;
+	thumb = elf.machine == EM_ARM;
+	elf_symbols(&elf, add_symbol, &thumb);
+	if(symbol_count == 0) {
+		fprintf(stderr, "no function symbols in '%s'\n", file_name);
+		return -1;
+	}
+	qsort(symbols, symbol_count, sizeof(symbol_t), by_address);
+	// aliases (weak handlers...) would get the same samples twice, keep one name
+	for(i = j = 1; i < symbol_count; i++)
+		if(symbols[i].addr != symbols[j - 1].addr)
+			symbols[j++] = symbols[i];
+	symbol_count = j;
+	return 0;
+}
+
+static uint32_t get32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+/*
+ * \brief share samples of address range between functions it overlaps
+ * \return samples not belonging to any function
+ */
+static double add_samples(uint32_t start, uint32_t end, double samples)
+{
+	double unknown = samples;
+	int i;
+
+	for(i = 0; i < symbol_count && symbols[i].addr < end; i++)
+	{
+		uint32_t lo = symbols[i].addr > start ? symbols[i].addr : start;
+		uint32_t hi = symbols[i].addr + symbols[i].size < end ? symbols[i].addr + symbols[i].size : end;
+		if(lo < hi) {
+			symbols[i].samples += samples * (hi - lo) / (end - start);
+			unknown -= samples * (hi - lo) / (end - start);
+		}
+	}
+	return unknown;
+}
+
+int main(int argc, char *argv[])
+{
+	const unsigned char *dump, *h = NULL;
+	long size, offset;
+	uint32_t base, samples, outside, halved, count;
+	int shift, buckets, i;
+	double total = 0, unknown = 0;
+
+	if(argc != 3) {
+		fputs(	"Flat profile from PC samples of stm32_dht22/src/pcsample.h\n"
+				"\nUsage:\n\tpcprof <firmware.elf> <dump>\n"
+				"\n\tdump is memory with pcsample variable, gdb:\n"
+				"\tdump binary value pcsample.bin pcsample\n", stderr);
+		return 1;
+	}
+	if(load_symbols(argv[1])) {
+		fprintf(stderr, "'%s' is not a little-endian ELF file with symbols\n", argv[1]);
+		return 1;
+	}
+	dump = read_file(argv[2], &size);
+	for(offset = 0; offset + PCSAMPLE_HEADER <= size; offset += 4)
+		if(get32(dump + offset) == PCSAMPLE_MAGIC) {
+			h = dump + offset;
+			break;
+		}
+	if(h == NULL || (buckets = get16(h + 10)) * 2 + PCSAMPLE_HEADER > size - offset || (shift = get16(h + 8)) > 31) {
+		fprintf(stderr, "no histogram in '%s'\n", argv[2]);
+		return 1;
+	}
+	base = get32(h + 4);
+	samples = get32(h + 12);
+	outside = get32(h + 16);
+	halved = get32(h + 20);
+
+	for(i = 0; i < buckets; i++)
+		if((count = get16(h + PCSAMPLE_HEADER + 2 * i)) != 0) {
+			total += count;
+			unknown += add_samples(base + (i << shift), base + ((i + 1) << shift), count);
+		}
+	if(total == 0) {
+		printf("no samples in histogram\n");
+		return 0;
+	}
+
+	printf("%u samples, %u (%.1f%%) outside of flash, bucket %d bytes", (unsigned)samples, (unsigned)outside,
+			samples ? 100.0 * outside / samples : 0.0, 1 << shift);
+	if(halved)
+		printf(", counts halved %u times", (unsigned)halved);
+	printf("\n\n      %%   samples  function\n");
+	qsort(symbols, symbol_count, sizeof(symbol_t), by_samples);
+	for(i = 0; i < symbol_count && symbols[i].samples > 0; i++)
+		printf("%7.2f %9.1f  %s\n", 100 * symbols[i].samples / total, symbols[i].samples, symbols[i].name);
+	if(unknown > 0.05)
+		printf("%7.2f %9.1f  <no symbol>\n", 100 * unknown / total, unknown);
+	return 0;
+}
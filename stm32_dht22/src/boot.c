@@ -0,0 +1,98 @@
+/*
+ * boot.c
+ */
+
+#include "diag/Trace.h"
+#include "boot.h"
+#include "clock.h"
+
+// everything is used before .data and .bss are initialized
+NOINIT uint32_t boot_tick_offset;
+static NOINIT uint32_t boot_magic;
+static NOINIT uint32_t boot_flags;
+static NOINIT uint8_t boot_is_warm;
+static NOINIT uint8_t boot_count;
+static NOINIT boot_mark_t boot_marks[BOOT_MAX_MARKS];
+
+static uint32_t boot_hz; // clock ticks are counted in
+
+void boot_start(void)
+{
+	// TIM2 is stopped and zero after any reset, ARR is 0xFFFFFFFF
+	RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+	TIM2->CR1 = TIM_CR1_CEN;
+	boot_tick_offset = 0;
+	boot_count = 0;
+
+	// RAM keeps magic only if power wasn't lost
+	boot_flags = RCC->CSR;
+	RCC->CSR |= RCC_CSR_RMVF;
+	boot_is_warm = boot_magic == BOOT_MAGIC && !(boot_flags & (RCC_CSR_PORRSTF | RCC_CSR_V18PWRRSTF));
+	boot_magic = BOOT_MAGIC;
+}
+
+void boot_mark(const char *phase)
+{
+	if(boot_count == BOOT_MAX_MARKS)
+		return;
+	boot_marks[boot_count].phase = phase;
+	boot_marks[boot_count].ticks = boot_ticks();
+	boot_count++;
+}
+
+static uint32_t boot_rescale(uint32_t ticks, uint32_t from_hz, uint32_t to_hz)
+{
+	return (uint64_t)ticks * (to_hz / 1000000) / (from_hz / 1000000);
+}
+
+/*
+ * from now on TIM2 counts at hz: convert the count so far and the marks to it, TIM2 itself
+ * is left alone for profile.h
+ */
+static int boot_clock_changed(clock_event_t event, uint32_t hz)
+{
+	uint32_t count;
+	int i;
+
+	if(event != CLOCK_CHANGED || hz == boot_hz)
+		return 0;
+	count = TIM2->CNT;
+	boot_tick_offset = boot_rescale(count + boot_tick_offset, boot_hz, hz) - count;
+	for(i = 0; i < boot_count; i++)
+		boot_marks[i].ticks = boot_rescale(boot_marks[i].ticks, boot_hz, hz);
+	boot_hz = hz;
+	return 0;
+}
+
+/*
+ * after .bss is cleared and SystemCoreClock is set by __initialize_hardware()
+ */
+static void __attribute__((constructor)) boot_clock_init(void)
+{
+	boot_hz = SystemCoreClock;
+	clock_register(boot_clock_changed);
+}
+
+void boot_print(void)
+{
+	uint32_t mhz = SystemCoreClock / 1000000, prev = 0;
+	int i;
+
+	trace_printf("boot: %s, reset flags 0x%08x\n", boot_is_warm ? "warm" : "cold", (unsigned)boot_flags);
+	for(i = 0; i < boot_count; i++)
+	{
+		trace_printf("  %-12s %8u us %8u us\n", boot_marks[i].phase, (unsigned)((boot_marks[i].ticks - prev) / mhz),
+				(unsigned)(boot_marks[i].ticks / mhz));
+		prev = boot_marks[i].ticks;
+	}
+}
+
+int boot_warm(void)
+{
+	return boot_is_warm;
+}
+
+uint32_t boot_reset_flags(void)
+{
+	return boot_flags;
+}
@@ -0,0 +1,87 @@
+/*
+ * boot.h
+ *
+ *  Boot time accounting and warm reset detection.
+ *
+ *  boot_start() is called by _start (system/src/newlib/_startup.c) right after clock setup,
+ *  it starts free running 32-bit TIM2 from core clock. Then _start and application mark
+ *  boot phases: "data", "bss", "paint", "hardware" come from _start, the rest from main().
+ *  boot_print() shows time of every phase, so it's seen where time from reset to first
+ *  sensor reading goes. profile.h uses the same TIM2 and doesn't restart it.
+ *
+ *  Ticks are cycles of the current core clock: on every clock_set() the marks and the count
+ *  are rescaled to the new frequency by a clock notifier, so boot_ms() and boot_print()
+ *  stay right after switching. The notifier is registered by a constructor, clock shouldn't
+ *  be changed before main().
+ *
+ *  Variables marked NOINIT are neither loaded nor cleared by _start, so they keep their
+ *  values over warm resets (NRST pin, watchdog, software). boot_warm() tells if they are
+ *  valid; after power-on they are garbage and must be initialized. Note, RAM is not kept
+ *  in Standby mode, wakeup from it is a cold boot.
+ *
+ *  Log and reset state are NOINIT too: boot_start() and boot_mark() run before .data and
+ *  .bss are initialized.
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+#include <cmsis_device.h>
+
+#define NOINIT __attribute__((section(".noinit")))
+
+#define BOOT_MAX_MARKS 16
+#define BOOT_MAGIC     0xB007C0DE
+
+// added to TIM2 count, keeps ticks counted at earlier clocks in units of the current one
+extern uint32_t boot_tick_offset;
+
+typedef struct {
+	const char *phase;
+	uint32_t    ticks;            // TIM2 count at the end of phase
+} boot_mark_t;
+
+/*
+ * \brief Start timebase and boot log, detect warm reset. Called by _start.
+ */
+void boot_start(void);
+
+/*
+ * \brief Note end of boot phase. phase must be string constant.
+ */
+void boot_mark(const char *phase);
+
+/*
+ * \brief Print phases with trace_printf(): time of each and since boot_start()
+ */
+void boot_print(void);
+
+/*
+ * \brief NOINIT variables survived reset
+ */
+int boot_warm(void);
+
+/*
+ * \brief RCC->CSR reset flags of this boot, RCC_CSR_*RSTF
+ */
+uint32_t boot_reset_flags(void);
+
+/*
+ * \brief Time since boot_start() in cycles of current core clock, wraps in ~90 s at 48 MHz
+ */
+static inline uint32_t boot_ticks(void)
+{
+	return TIM2->CNT + boot_tick_offset;
+}
+
+/*
+ * \brief Milliseconds since boot_start(), timebase for boot sequencing only: not monotonic
+ *        when TIM2 wraps
+ */
+static inline uint32_t boot_ms(void)
+{
+	return boot_ticks() / (SystemCoreClock / 1000);
+}
+
+#endif /* BOOT_H_ */
@@ -0,0 +1,141 @@
+/*
+ * clock.c
+ */
+
+#include <cmsis_device.h>
+#include "diag/Trace.h"
+#include "clock.h"
+
+static const uint32_t clock_hz[] = { 8000000, 24000000, 48000000 };
+
+static clock_notifier_t clock_notifiers[CLOCK_MAX_NOTIFIERS];
+
+/*
+ * \return nonzero if some notifier refused, the rest are not called then
+ */
+static int clock_notify(clock_event_t event, uint32_t hz)
+{
+	int i;
+
+	for(i = 0; i < CLOCK_MAX_NOTIFIERS; i++)
+		if(clock_notifiers[i] && clock_notifiers[i](event, hz) && event == CLOCK_CHANGING) {
+			// tell the ones which agreed that clock stays
+			while(i--)
+				if(clock_notifiers[i])
+					clock_notifiers[i](CLOCK_CHANGED, SystemCoreClock);
+			return -1;
+		}
+	return 0;
+}
+
+/*
+ * select system clock source and wait until it is used, SWS is SW shifted by 2
+ */
+static void clock_switch(uint32_t source)
+{
+	RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | source;
+	while((RCC->CFGR & RCC_CFGR_SWS) != source << 2);
+}
+
+/*
+ * \return 0 if PLL locked at hz
+ */
+static int clock_pll_start(uint32_t hz)
+{
+	uint32_t source, input, timeout = CLOCK_PLL_TIMEOUT;
+
+	if(RCC->CR & RCC_CR_HSERDY) {
+		// PREDIV is 1
+		source = RCC_CFGR_PLLSRC_PREDIV1 | RCC_CFGR_PLLXTPRE_PREDIV1;
+		input = HSE_VALUE;
+	}
+	else {
+		source = RCC_CFGR_PLLSRC_HSI_Div2;
+		input = HSI_VALUE / 2;
+	}
+	// PLLMUL field is factor - 2
+	RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_PLLSRC | RCC_CFGR_PLLXTPRE | RCC_CFGR_PLLMULL))
+			| source | ((hz / input - 2) << 18);
+	RCC->CR |= RCC_CR_PLLON;
+	while(!(RCC->CR & RCC_CR_PLLRDY))
+		if(--timeout == 0) {
+			RCC->CR &= ~RCC_CR_PLLON;
+			return -1;
+		}
+	return 0;
+}
+
+int clock_set(clock_mode_t mode)
+{
+	uint32_t hz = clock_hz[mode], primask;
+	int result = 0;
+
+	if(mode == clock_get())
+		return 0;
+	if(clock_notify(CLOCK_CHANGING, hz))
+		return -2;
+#if defined(TRACE) && defined(OS_USE_TRACE_RINGBUF_USART)
+	trace_usart_clock_changing();
+#endif
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	// one wait state above 24 MHz, set before going up
+	if(hz > 24000000)
+		FLASH->ACR |= FLASH_ACR_LATENCY;
+	// PLL can't be changed while it runs the core
+	RCC->CR |= RCC_CR_HSION;
+	while(!(RCC->CR & RCC_CR_HSIRDY));
+	clock_switch(RCC_CFGR_SW_HSI);
+	RCC->CR &= ~RCC_CR_PLLON;
+	while(RCC->CR & RCC_CR_PLLRDY);
+	if(mode != CLOCK_HSI8) {
+		if(clock_pll_start(hz) == 0)
+			clock_switch(RCC_CFGR_SW_PLL);
+		else
+			result = -1;
+	}
+	SystemCoreClockUpdate();
+	if(SystemCoreClock <= 24000000)
+		FLASH->ACR &= ~FLASH_ACR_LATENCY;
+
+#if defined(TRACE) && defined(OS_USE_TRACE_RINGBUF_USART)
+	trace_usart_clock_changed();
+#endif
+	clock_notify(CLOCK_CHANGED, SystemCoreClock);
+	__set_PRIMASK(primask);
+	return result;
+}
+
+clock_mode_t clock_get(void)
+{
+	if((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+		return CLOCK_HSI8;
+	return SystemCoreClock > 24000000 ? CLOCK_PLL48 : CLOCK_PLL24;
+}
+
+int clock_register(clock_notifier_t notifier)
+{
+	int i, slot = -1;
+
+	for(i = 0; i < CLOCK_MAX_NOTIFIERS; i++)
+	{
+		if(clock_notifiers[i] == notifier)
+			return 0;
+		if(clock_notifiers[i] == NULL && slot < 0)
+			slot = i;
+	}
+	if(slot < 0)
+		return -1;
+	clock_notifiers[slot] = notifier;
+	return 0;
+}
+
+void clock_unregister(clock_notifier_t notifier)
+{
+	int i;
+
+	for(i = 0; i < CLOCK_MAX_NOTIFIERS; i++)
+		if(clock_notifiers[i] == notifier)
+			clock_notifiers[i] = NULL;
+}
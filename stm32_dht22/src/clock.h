@@ -0,0 +1,65 @@
+/*
+ * clock.h
+ *
+ *  Runtime system clock scaling: HSI 8 MHz to idle, PLL 24 or 48 MHz to decode and flush.
+ *  PLL runs from HSE (8 MHz, as SystemInit() sets it up) if it's ready, otherwise from HSI/2.
+ *  Flash latency is raised before clock goes up and lowered after it goes down,
+ *  SystemCoreClockUpdate() is called, AHB and APB prescalers stay 1.
+ *
+ *  Whoever derives timing from SystemCoreClock registers a notifier. It is called twice
+ *  for every change, with the new frequency:
+ *  CLOCK_CHANGING -- before switch, interrupts enabled: finish or pause what is in flight,
+ *                    or return nonzero to refuse the switch while it can't be paused;
+ *  CLOCK_CHANGED  -- after switch, interrupts disabled: recompute constants, keep it short.
+ *  When the switch is refused, notifiers get CLOCK_CHANGED with unchanged frequency.
+ *  The trace USART (OS_USE_TRACE_RINGBUF_USART) is handled by clock_set() itself.
+ *
+ *  TIM2 keeps counting core cycles of whatever clock runs: boot.h rescales its ticks to the
+ *  current clock, profile.h statistics stay in cycles.
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+
+#define CLOCK_MAX_NOTIFIERS 6
+#define CLOCK_PLL_TIMEOUT   0x5000 // polls of PLLRDY
+
+typedef enum {
+	CLOCK_HSI8 = 0,
+	CLOCK_PLL24 = 1,
+	CLOCK_PLL48 = 2
+} clock_mode_t;
+
+typedef enum {
+	CLOCK_CHANGING = 0,
+	CLOCK_CHANGED = 1
+} clock_event_t;
+
+/*
+ * \return nonzero on CLOCK_CHANGING to refuse switch, ignored on CLOCK_CHANGED
+ */
+typedef int (*clock_notifier_t)(clock_event_t event, uint32_t hz);
+
+/*
+ * \brief Switch system clock
+ * \return 0 if successful, -1 if PLL didn't lock: system is left on HSI 8 MHz
+ *         and notifiers know it, -2 if a notifier refused: nothing is changed
+ */
+int clock_set(clock_mode_t mode);
+
+/*
+ * \brief Current mode, by clock switch state and SystemCoreClock
+ */
+clock_mode_t clock_get(void);
+
+/*
+ * \brief Add notifier, registering the same one twice is harmless
+ * \return 0 if successful, -1 if table is full
+ */
+int clock_register(clock_notifier_t notifier);
+
+void clock_unregister(clock_notifier_t notifier);
+
+#endif /* CLOCK_H_ */
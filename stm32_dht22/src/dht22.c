@@ -23,7 +23,11 @@
  *
  */
 
+#include <stddef.h>
 #include "dht22.h"
+#include "profile.h"
+#include "ramfunc.h"
+#include "clock.h"
 
 #ifdef DHT22_ASYNC
 
@@ -33,6 +37,21 @@ GPIO_InitTypeDef GPIO_initStruct;
 EXTI_InitTypeDef EXTI_initStruct;
 NVIC_InitTypeDef NVIC_initStruct;
 
+/*
+ * durations are measured in core cycles by SysTick. Counting SysTick can't be rescaled
+ * (writing VAL clears it), so clock is not switched in the middle of metering.
+ */
+static int dht22_clock_changed(clock_event_t event, uint32_t hz)
+{
+	if(dht22_data == NULL)
+		return 0;
+	if(event == CLOCK_CHANGING)
+		return dht22_data->metering_stage != DHT22_done;
+	dht22_data->timeout = hz / (1000000 / DHT22_TIMEOUT);
+	dht22_data->max_zero_duration = hz / (1000000 / DHT22_MAX_ZERO_LEN);
+	return 0;
+}
+
 dht22_result_t dht22_start_metering(dht22_t *data)
 {
 	// 1
@@ -46,6 +65,8 @@ dht22_result_t dht22_start_metering(dht22_t *data)
 	GPIO_Init(DHT22_PORT, &GPIO_initStruct);
 	GPIO_ResetBits(DHT22_PORT, DHT22_PIN);
 	// 2
+	if(dht22_data == NULL)
+		clock_register(dht22_clock_changed); // once, on the first metering
 	dht22_data = data;
 	dht22_data->metering_stage = DHT22_sendStrobe0;
 	dht22_data->result = DHT22_ERR_METERING;
@@ -62,6 +83,7 @@ dht22_result_t dht22_start_metering(dht22_t *data)
 
 void SysTick_Handler(void)
 {
+	PROFILE_SCOPE("dht22 SysTick");
 	if(dht22_data->metering_stage == DHT22_done)
 		return;
 	if(dht22_data->metering_stage == DHT22_sendStrobe0) {
@@ -97,8 +119,9 @@ void SysTick_Handler(void)
 	}
 }
 
-void EXTI4_15_IRQHandler(void)
+RAMFUNC void EXTI4_15_IRQHandler(void)
 {
+	PROFILE_SCOPE("dht22 EXTI");
 	if(EXTI_GetITStatus(DHT22_EXTI_LINE) != RESET) {
 		// 4.1
 		if(!(DHT22_PORT->IDR & DHT22_PIN)) {
@@ -0,0 +1,184 @@
+/*
+ * irqlat.c
+ */
+
+#ifdef IRQLAT
+
+#include <stdio.h>
+#include "diag/Trace.h"
+#include "dht22.h"
+#include "lcd_nokia.h"
+#include "irqlat.h"
+#include "ramfunc.h"
+#include "lcd_spi.h"
+
+#ifdef DHT22_ASYNC
+#error "IRQLAT takes EXTI4_15 interrupt from async DHT22 code, build one of them"
+#endif
+#if IRQLAT_OUT_PORT_INDEX == LCD_PORT_INDEX && IRQLAT_OUT_PIN_NUM == LCD_RESET_PIN_NUM
+#error "IRQLAT output is LCD reset pin, choose another TIM3_CH1 pin"
+#endif
+
+#define IRQLAT_ZERO_LEN 28 // usec, the longest "0" pulse by datasheet
+
+static volatile irqlat_stats_t irqlat_stats;
+static uint32_t irqlat_period;
+static uint8_t irqlat_level;
+
+static void irqlat_lcd(void)
+{
+	lcd_fb_show();
+}
+
+static void irqlat_trace(void)
+{
+	trace_printf("irqlat: trace load %u\n", (unsigned)irqlat_stats.count);
+}
+
+static void irqlat_format(void)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "t:%d.%d h:%u", -123 / 10, 123 % 10, (unsigned)irqlat_stats.count);
+}
+
+const irqlat_load_t irqlat_loads[] = {
+	{ "idle",   NULL },
+	{ "lcd",    irqlat_lcd },
+	{ "trace",  irqlat_trace },
+	{ "format", irqlat_format },
+	{ NULL, NULL }
+};
+
+static void irqlat_start(void)
+{
+	GPIO_InitTypeDef gpio;
+	EXTI_InitTypeDef exti;
+	NVIC_InitTypeDef nvic;
+	int i;
+
+	irqlat_stats.count = irqlat_stats.max = irqlat_stats.total = irqlat_stats.missed = 0;
+	irqlat_stats.min = 0xFFFFFFFF;
+	for(i = 0; i < IRQLAT_BUCKETS; i++)
+		irqlat_stats.histogram[i] = 0;
+
+	RCC_AHBPeriphClockCmd(IRQLAT_OUT_AHBPERIPH | DHT22_AHBPERIPH, ENABLE);
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+	GPIO_PinAFConfig(IRQLAT_OUT_PORT, IRQLAT_OUT_PIN_NUM, IRQLAT_OUT_AF);
+	gpio.GPIO_Pin = 1 << IRQLAT_OUT_PIN_NUM;
+	gpio.GPIO_Mode = GPIO_Mode_AF;
+	gpio.GPIO_Speed = GPIO_Speed_Level_3;
+	gpio.GPIO_OType = GPIO_OType_PP;
+	gpio.GPIO_PuPd = GPIO_PuPd_NOPULL;
+	GPIO_Init(IRQLAT_OUT_PORT, &gpio);
+	gpio.GPIO_Pin = DHT22_PIN;
+	gpio.GPIO_Mode = GPIO_Mode_IN;
+	GPIO_Init(DHT22_PORT, &gpio);
+
+	// toggle output at the middle of period, so latency up to half period doesn't wrap
+	irqlat_period = SystemCoreClock / 1000000 * IRQLAT_PERIOD_US;
+	RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+	TIM3->CR1 = 0;
+	TIM3->PSC = 0;
+	TIM3->ARR = irqlat_period - 1;
+	TIM3->CCR1 = irqlat_period / 2;
+	TIM3->CCMR1 = TIM_CCMR1_OC1M_0 | TIM_CCMR1_OC1M_1; // toggle on match
+	TIM3->CCER = TIM_CCER_CC1E;
+	TIM3->EGR = TIM_EGR_UG;
+	irqlat_level = (DHT22_PORT->IDR & DHT22_PIN) != 0;
+
+	SYSCFG_EXTILineConfig(DHT22_EXTI_PORT, DHT22_PIN_NUM);
+	exti.EXTI_Line = DHT22_EXTI_LINE;
+	exti.EXTI_Mode = EXTI_Mode_Interrupt;
+	exti.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+	exti.EXTI_LineCmd = ENABLE;
+	EXTI_Init(&exti);
+	EXTI_ClearITPendingBit(DHT22_EXTI_LINE);
+	nvic.NVIC_IRQChannel = EXTI4_15_IRQn;
+	nvic.NVIC_IRQChannelPriority = IRQLAT_PRIORITY;
+	nvic.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&nvic);
+
+	TIM3->CR1 = TIM_CR1_CEN;
+}
+
+static void irqlat_stop(void)
+{
+	GPIO_InitTypeDef gpio;
+
+	TIM3->CR1 = 0;
+	NVIC_DisableIRQ(EXTI4_15_IRQn);
+	EXTI->IMR &= ~DHT22_EXTI_LINE;
+	// release jumper, so it doesn't drive DHT22 line
+	gpio.GPIO_Pin = 1 << IRQLAT_OUT_PIN_NUM;
+	gpio.GPIO_Mode = GPIO_Mode_IN;
+	gpio.GPIO_Speed = GPIO_Speed_Level_3;
+	gpio.GPIO_OType = GPIO_OType_PP;
+	gpio.GPIO_PuPd = GPIO_PuPd_NOPULL;
+	GPIO_Init(IRQLAT_OUT_PORT, &gpio);
+}
+
+RAMFUNC void EXTI4_15_IRQHandler(void)
+{
+	// timestamp first, like dht22.c does
+	uint32_t now = TIM3->CNT, latency, level;
+
+	EXTI->PR = DHT22_EXTI_LINE;
+	latency = now >= TIM3->CCR1 ? now - TIM3->CCR1 : now + irqlat_period - TIM3->CCR1;
+	level = (DHT22_PORT->IDR & DHT22_PIN) != 0;
+	if(level == irqlat_level)
+		irqlat_stats.missed++; // two edges for one interrupt
+	irqlat_level = level;
+
+	if(latency < irqlat_stats.min)
+		irqlat_stats.min = latency;
+	if(latency > irqlat_stats.max)
+		irqlat_stats.max = latency;
+	irqlat_stats.total += latency;
+	irqlat_stats.count++;
+	latency /= IRQLAT_BUCKET;
+	irqlat_stats.histogram[latency < IRQLAT_BUCKETS ? latency : IRQLAT_BUCKETS - 1]++;
+}
+
+static void irqlat_report(const char *name, const irqlat_stats_t *s)
+{
+	uint32_t mhz = SystemCoreClock / 1000000, jitter = s->max - s->min;
+	int i;
+
+	trace_printf("irqlat %s: %u edges, %u missed, latency min %u mean %u max %u cycles, jitter %u.%02u us\n",
+			name, (unsigned)s->count, (unsigned)s->missed, (unsigned)s->min,
+			(unsigned)(s->total / s->count), (unsigned)s->max,
+			(unsigned)(jitter / mhz), (unsigned)(jitter % mhz * 100 / mhz));
+	// "well under" margin: pulse error up to half of it
+	trace_printf("  pulse error margin %u us: %s\n", DHT22_MAX_ZERO_LEN - IRQLAT_ZERO_LEN,
+			!s->missed && jitter < (DHT22_MAX_ZERO_LEN - IRQLAT_ZERO_LEN) * mhz / 2 ? "ok" : "exceeded");
+	for(i = 0; i < IRQLAT_BUCKETS; i++)
+		if(s->histogram[i])
+			trace_printf("  %4u%s %u\n", i * IRQLAT_BUCKET, i == IRQLAT_BUCKETS - 1 ? "+" : " ",
+					(unsigned)s->histogram[i]);
+}
+
+void irqlat_measure(const irqlat_load_t *load, irqlat_stats_t *stats)
+{
+	irqlat_stats_t copy;
+
+	irqlat_start();
+	while(irqlat_stats.count < IRQLAT_EDGES)
+		if(load && load->run)
+			load->run();
+	irqlat_stop();
+	copy = *(irqlat_stats_t *)&irqlat_stats;
+	irqlat_report(load ? load->name : "idle", &copy);
+	if(stats)
+		*stats = copy;
+}
+
+void irqlat_loop(void)
+{
+	const irqlat_load_t *load;
+
+	while(1)
+		for(load = irqlat_loads; load->name; load++)
+			irqlat_measure(load, NULL);
+}
+
+#endif // IRQLAT
@@ -0,0 +1,79 @@
+/*
+ * irqlat.h
+ *
+ *  Harness for measuring interrupt latency on DHT22 pin. TIM3 toggles PB4 (TIM3_CH1) every
+ *  IRQLAT_PERIOD_US, jumper it to DHT22 pin (PB9) instead of sensor. TIM3_CH1 is also on PA6,
+ *  but that is LCD reset with SPI1, and on PC6 (AF0), see IRQLAT_OUT_*. EXTI handler takes timestamp
+ *  the same way async DHT22 code does, at its start, and difference with compare value
+ *  of edge is the latency, in core cycles (timer is clocked like core, APB prescaler 1).
+ *
+ *  DHT22 bit is decided by pulse length, so difference of latencies of two edges is
+ *  the error of measured pulse. It must stay well under margin between "0" pulse (28 us)
+ *  and DHT22_MAX_ZERO_LEN; every report shows it.
+ *
+ *  Latency is measured while main loop runs one of background loads (irqlat_loads[]),
+ *  distribution is printed by trace_printf(). Interrupt priority is IRQLAT_PRIORITY,
+ *  change it (or ISR code) and compare reports.
+ *  Compiled only if IRQLAT is defined, and not together with DHT22_ASYNC: both need EXTI4_15.
+ */
+
+#ifndef IRQLAT_H_
+#define IRQLAT_H_
+
+#include <stdint.h>
+
+#ifndef IRQLAT_OUT_PIN_NUM
+#define IRQLAT_OUT_PORT       GPIOB
+#define IRQLAT_OUT_PORT_INDEX 1      // 0 is GPIOA, 1 is GPIOB...
+#define IRQLAT_OUT_PIN_NUM    4
+#define IRQLAT_OUT_AF         GPIO_AF_1
+#define IRQLAT_OUT_AHBPERIPH  RCC_AHBPeriph_GPIOB
+#endif
+
+#ifndef IRQLAT_PERIOD_US
+#define IRQLAT_PERIOD_US 50   // between edges, about as often as DHT22 sends them
+#endif
+#ifndef IRQLAT_PRIORITY
+#define IRQLAT_PRIORITY  0    // the same as DHT22 EXTI
+#endif
+#ifndef IRQLAT_EDGES
+#define IRQLAT_EDGES     10000 // per load
+#endif
+
+#define IRQLAT_BUCKETS   32
+#define IRQLAT_BUCKET    16   // cycles per histogram bucket, the last one takes all longer
+
+typedef struct {
+	const char *name;
+	void (*run)(void);         // called repeatedly while edges are measured
+} irqlat_load_t;
+
+typedef struct {
+	uint32_t count, min, max;
+	uint32_t total;
+	uint32_t missed;           // edges without interrupt, pin level didn't change
+	uint16_t histogram[IRQLAT_BUCKETS];
+} irqlat_stats_t;
+
+#ifdef IRQLAT
+
+/*
+ * background loads: idle, LCD flush, trace output, formatting; terminated by NULL name
+ */
+extern const irqlat_load_t irqlat_loads[];
+
+/*
+ * \brief Measure IRQLAT_EDGES edges while load runs, print distribution
+ * \param load what to do in the meantime, NULL for idle loop
+ * \param stats where to store results, may be NULL
+ */
+void irqlat_measure(const irqlat_load_t *load, irqlat_stats_t *stats);
+
+/*
+ * \brief Measure all loads in turn, forever. LCD must be initialized with framebuffer.
+ */
+void irqlat_loop(void) __attribute__((noreturn));
+
+#endif // IRQLAT
+
+#endif /* IRQLAT_H_ */
@@ -1,177 +1,196 @@
 /*
- * lcd_chars.h
- *
- *  Created on: Nov 6, 2015
- *      Author: andrey
+ * lcd_chars6x8 font 6x8 generated by fontconv, for lcd_putc()
  */
 
-#ifndef LCD_CHARS_H_
-#define LCD_CHARS_H_
+#ifndef LCD_CHARS6X8_H_
+#define LCD_CHARS6X8_H_
+
+#include "charset.h"
+
+#define LCD_CHARS6X8_WIDTH    6
+#define LCD_CHARS6X8_PAGES    1
 
 /*
- * character images 6x8. ASCII 0x20..0x7E and Windows-1251 0xC0..0xCF
+ * glyphs: columns of 8 pixels, page by page, 163 chars in 162 glyphs
  */
 const uint8_t lcd_chars6x8[][6] = {
-	{0x00, 0x00, 0x00, 0x00, 0x00}, // 0x20' '
-	{0x00, 0x00, 0x5E, 0x00, 0x00}, // 0x21'!'
-	{0x00, 0x06, 0x00, 0x06, 0x00}, // 0x22'"'
-	{0x24, 0x7E, 0x24, 0x7E, 0x24}, // 0x23'#'
-	{0x08, 0x54, 0xD6, 0x54, 0x20}, // 0x24'$'
-	{0x44, 0x20, 0x10, 0x08, 0x44}, // 0x25'%'
-	{0x34, 0x4A, 0x54, 0x20, 0x50}, // 0x26'&'
-	{0x00, 0x00, 0x06, 0x00, 0x00}, // 0x27'''
-	{0x00, 0x3C, 0x42, 0x00, 0x00}, // 0x28'('
-	{0x00, 0x00, 0x42, 0x3C, 0x00}, // 0x29')'
-	{0x00, 0x14, 0x08, 0x14, 0x00}, // 0x2A'*'
-	{0x10, 0x10, 0x7C, 0x10, 0x10}, // 0x2B'+'
-	{0x00, 0x80, 0x40, 0x00, 0x00}, // 0x2C','
-	{0x10, 0x10, 0x10, 0x10, 0x00}, // 0x2D'-'
-	{0x00, 0x00, 0x40, 0x00, 0x00}, // 0x2E'.'
-	{0x00, 0x60, 0x18, 0x06, 0x00}, // 0x2F'/'
-	{0x3C, 0x62, 0x5A, 0x46, 0x3C}, // 0x30'0'
-	{0x00, 0x08, 0x04, 0x7E, 0x00}, // 0x31'1'
-	{0x64, 0x52, 0x52, 0x52, 0x4C}, // 0x32'2'
-	{0x24, 0x42, 0x4A, 0x4A, 0x34}, // 0x33'3'
-	{0x1E, 0x10, 0x10, 0x10, 0x7E}, // 0x34'4'
-	{0x26, 0x4A, 0x4A, 0x4A, 0x32}, // 0x35'5'
-	{0x3C, 0x4A, 0x4A, 0x4A, 0x30}, // 0x36'6'
-	{0x02, 0x02, 0x72, 0x0A, 0x06}, // 0x37'7'
-	{0x34, 0x4A, 0x4A, 0x4A, 0x34}, // 0x38'8'
-	{0x0C, 0x52, 0x52, 0x52, 0x3C}, // 0x39'9'
-	{0x00, 0x00, 0x44, 0x00, 0x00}, // 0x3A':'
-	{0x00, 0x80, 0x44, 0x00, 0x00}, // 0x3B';'
-	{0x00, 0x10, 0x28, 0x44, 0x00}, // 0x3C'<'
-	{0x00, 0x28, 0x28, 0x28, 0x00}, // 0x3D'='
-	{0x00, 0x44, 0x28, 0x10, 0x00}, // 0x3E'>'
-	{0x00, 0x02, 0x5A, 0x04, 0x00}, // 0x3F'?'
-	{0x3C, 0x42, 0x5A, 0x52, 0x0C}, // 0x40'@'
-	{0x7C, 0x12, 0x12, 0x12, 0x7C}, // 0x41'A'
-	{0x7E, 0x4A, 0x4A, 0x4A, 0x34}, // 0x42'B'
-	{0x3C, 0x42, 0x42, 0x42, 0x24}, // 0x43'C'
-	{0x7E, 0x42, 0x42, 0x42, 0x3C}, // 0x44'D'
-	{0x7E, 0x4A, 0x4A, 0x42, 0x42}, // 0x45'E'
-	{0x7E, 0x0A, 0x0A, 0x0A, 0x02}, // 0x46'F'
-	{0x3C, 0x42, 0x52, 0x52, 0x34}, // 0x47'G'
-	{0x7E, 0x08, 0x08, 0x08, 0x7E}, // 0x48'H'
-	{0x42, 0x42, 0x7E, 0x42, 0x42}, // 0x49'I'
-	{0x42, 0x42, 0x3E, 0x02, 0x02}, // 0x4A'J'
-	{0x7E, 0x08, 0x08, 0x14, 0x62}, // 0x4B'K'
-	{0x7E, 0x40, 0x40, 0x40, 0x40}, // 0x4C'L'
-	{0x7E, 0x04, 0x18, 0x04, 0x7E}, // 0x4D'M'
-	{0x7E, 0x04, 0x08, 0x10, 0x7E}, // 0x4E'N'
-	{0x3C, 0x42, 0x42, 0x42, 0x3C}, // 0x4F'O'
-	{0x7E, 0x12, 0x12, 0x12, 0x0C}, // 0x50'P'
-	{0x3C, 0x42, 0x42, 0x42, 0xBC}, // 0x51'Q'
-	{0x7E, 0x12, 0x12, 0x12, 0x6C}, // 0x52'R'
-	{0x24, 0x4A, 0x4A, 0x52, 0x24}, // 0x53'S'
-	{0x02, 0x02, 0x7E, 0x02, 0x02}, // 0x54'T'
-	{0x3E, 0x40, 0x40, 0x40, 0x3E}, // 0x55'U'
-	{0x06, 0x18, 0x60, 0x18, 0x06}, // 0x56'V'
-	{0x3E, 0x40, 0x30, 0x40, 0x3E}, // 0x57'W'
-	{0x42, 0x24, 0x18, 0x24, 0x42}, // 0x58'X'
-	{0x06, 0x08, 0x70, 0x08, 0x06}, // 0x59'Y'
-	{0x62, 0x52, 0x4A, 0x46, 0x42}, // 0x5A'Z'
-	{0x00, 0x7E, 0x42, 0x00, 0x00}, // 0x5B'['
-	{0x00, 0x06, 0x18, 0x60, 0x00}, // 0x5C'\'
-	{0x00, 0x00, 0x42, 0x7E, 0x00}, // 0x5D']'
-	{0x00, 0x04, 0x02, 0x04, 0x00}, // 0x5E'^'
-	{0x40, 0x40, 0x40, 0x40, 0x40}, // 0x5F'_'
-	{0x00, 0x02, 0x04, 0x00, 0x00}, // 0x60'`'
-	{0x20, 0x54, 0x54, 0x78, 0x00}, // 0x61'a'
-	{0x7E, 0x48, 0x48, 0x30, 0x00}, // 0x62'b'
-	{0x38, 0x44, 0x44, 0x28, 0x00}, // 0x63'c'
-	{0x30, 0x48, 0x48, 0x7E, 0x00}, // 0x64'd'
-	{0x38, 0x54, 0x54, 0x18, 0x00}, // 0x65'e'
-	{0x10, 0x7C, 0x12, 0x02, 0x00}, // 0x66'f'
-	{0x18, 0xA4, 0xA4, 0x78, 0x00}, // 0x67'g'
-	{0x7E, 0x08, 0x08, 0x70, 0x00}, // 0x68'h'
-	{0x00, 0x00, 0x7A, 0x00, 0x00}, // 0x69'i'
-	{0x80, 0x80, 0x7A, 0x00, 0x00}, // 0x6A'j'
-	{0x7E, 0x10, 0x28, 0x40, 0x00}, // 0x6B'k'
-	{0x00, 0x00, 0x3E, 0x40, 0x00}, // 0x6C'l'
-	{0x7C, 0x04, 0x18, 0x04, 0x78}, // 0x6D'm'
-	{0x7C, 0x08, 0x04, 0x78, 0x00}, // 0x6E'n'
-	{0x38, 0x44, 0x44, 0x38, 0x00}, // 0x6F'o'
-	{0xFC, 0x24, 0x24, 0x18, 0x00}, // 0x70'p'
-	{0x18, 0x24, 0x24, 0xFC, 0x00}, // 0x71'q'
-	{0x7C, 0x08, 0x04, 0x04, 0x00}, // 0x72'r'
-	{0x48, 0x54, 0x54, 0x24, 0x00}, // 0x73's'
-	{0x08, 0x3E, 0x48, 0x40, 0x00}, // 0x74't'
-	{0x3C, 0x40, 0x40, 0x3C, 0x00}, // 0x75'u'
-	{0x1C, 0x20, 0x40, 0x20, 0x1C}, // 0x76'v'
-	{0x3C, 0x40, 0x30, 0x40, 0x3C}, // 0x77'w'
-	{0x44, 0x28, 0x10, 0x28, 0x44}, // 0x78'x'
-	{0x1C, 0xA0, 0xA0, 0x7C, 0x00}, // 0x79'y'
-	{0x44, 0x64, 0x54, 0x4C, 0x00}, // 0x7A'z'
-	{0x10, 0x6C, 0x82, 0x00, 0x00}, // 0x7B'{'
-	{0x00, 0x00, 0xFE, 0x00, 0x00}, // 0x7C'|'
-	{0x00, 0x00, 0x82, 0x6C, 0x10}, // 0x7D'}'
-	{0x08, 0x04, 0x0C, 0x08, 0x04}, // 0x7E'~'
-	{0x78, 0x14, 0x12, 0x14, 0x78}, // 0xC0'А'
-	{0x7E, 0x4A, 0x4A, 0x4A, 0x30}, // 0xC1'Б'
-	{0x7E, 0x4A, 0x4A, 0x4C, 0x30}, // 0xC2'В'
-	{0x7E, 0x02, 0x02, 0x02, 0x02}, // 0xC3'Г'
-	{0x60, 0x3C, 0x22, 0x3E, 0x60}, // 0xC4'Д'
-	{0x7E, 0x4A, 0x4A, 0x42, 0x42}, // 0xC5'Е'
-	{0x66, 0x18, 0x7E, 0x18, 0x66}, // 0xC6'Ж'
-	{0x42, 0x42, 0x4A, 0x4A, 0x34}, // 0xC7'З'
-	{0x7E, 0x10, 0x08, 0x04, 0x7E}, // 0xC8'И'
-	{0x7E, 0x10, 0x09, 0x04, 0x7E}, // 0xC9'Й'
-	{0x7E, 0x10, 0x08, 0x14, 0x62}, // 0xCA'К'
-	{0x40, 0x3C, 0x02, 0x02, 0x7E}, // 0xCB'Л'
-	{0x7E, 0x04, 0x08, 0x04, 0x7E}, // 0xCC'М'
-	{0x7E, 0x08, 0x08, 0x08, 0x7E}, // 0xCD'Н'
-	{0x3C, 0x42, 0x42, 0x42, 0x3C}, // 0xCE'О'
-	{0x7E, 0x02, 0x02, 0x02, 0x7E}, // 0xCF'П'
-	{0x7E, 0x12, 0x12, 0x12, 0x0C}, // 0xD0'Р'
-	{0x3C, 0x42, 0x42, 0x42, 0x24}, // 0xD1'С'
-	{0x02, 0x02, 0x7E, 0x02, 0x02}, // 0xD2'Т'
-	{0x46, 0x28, 0x10, 0x08, 0x06}, // 0xD3'У'
-	{0x1C, 0x22, 0x7E, 0x22, 0x1C}, // 0xD4'Ф'
-	{0x42, 0x24, 0x18, 0x24, 0x42}, // 0xD5'Х'
-	{0x7E, 0x40, 0x40, 0x7E, 0xC0}, // 0xD6'Ц'
-	{0x0E, 0x10, 0x10, 0x10, 0x7E}, // 0xD7'Ч'
-	{0x7E, 0x40, 0x7C, 0x40, 0x7E}, // 0xD8'Ш'
-	{0x7E, 0x40, 0x7C, 0x40, 0xFE}, // 0xD9'Щ'
-	{0x02, 0x7E, 0x48, 0x48, 0x30}, // 0xDA'Ъ'
-	{0x7E, 0x48, 0x30, 0x00, 0x7E}, // 0xDB'Ы'
-	{0x7E, 0x48, 0x48, 0x48, 0x30}, // 0xDC'Ь'
-	{0x42, 0x4A, 0x4A, 0x4A, 0x3C}, // 0xDD'Э'
-	{0x7E, 0x08, 0x3C, 0x42, 0x3C}, // 0xDE'Ю'
-	{0x4C, 0x52, 0x32, 0x12, 0x7E}, // 0xDF'Я'
-	{0x20, 0x54, 0x54, 0x78, 0x00}, // 0xE0'а'
-	{0x7C, 0x54, 0x54, 0x20, 0x00}, // 0xE1'б'
-	{0x7C, 0x54, 0x54, 0x28, 0x00}, // 0xE2'в'
-	{0x7C, 0x04, 0x04, 0x04, 0x00}, // 0xE3'г'
-	{0xC0, 0x78, 0x44, 0x7C, 0xC0}, // 0xE4'д'
-	{0x38, 0x54, 0x54, 0x18, 0x00}, // 0xE5'е'
-	{0x64, 0x18, 0x7C, 0x18, 0x64}, // 0xE6'ж'
-	{0x00, 0x44, 0x54, 0x54, 0x28}, // 0xE7'з'
-	{0x7C, 0x20, 0x10, 0x7C, 0x00}, // 0xE8'и'
-	{0x78, 0x22, 0x12, 0x78, 0x00}, // 0xE9'й'
-	{0x7C, 0x10, 0x28, 0x44, 0x00}, // 0xEA'к'
-	{0x40, 0x3C, 0x04, 0x7C, 0x00}, // 0xEB'л'
-	{0x7C, 0x08, 0x10, 0x08, 0x7C}, // 0xEC'м'
-	{0x7C, 0x10, 0x10, 0x7C, 0x00}, // 0xED'н'
-	{0x38, 0x44, 0x44, 0x38, 0x00}, // 0xEE'о'
-	{0x7C, 0x04, 0x04, 0x7C, 0x00}, // 0xEF'п'
-	{0xFC, 0x24, 0x24, 0x18, 0x00}, // 0xF0'р'
-	{0x38, 0x44, 0x44, 0x28, 0x00}, // 0xF1'с'
-	{0x00, 0x04, 0x7C, 0x04, 0x00}, // 0xF2'т'
-	{0x44, 0x28, 0x10, 0x08, 0x04}, // 0xF3'у'
-	{0x30, 0x48, 0xFC, 0x48, 0x30}, // 0xF4'ф'
-	{0x44, 0x28, 0x10, 0x28, 0x44}, // 0xF5'х'
-	{0x7C, 0x40, 0x40, 0x7C, 0x80}, // 0xF6'ц'
-	{0x0C, 0x10, 0x10, 0x7C, 0x00}, // 0xF7'ч'
-	{0x7C, 0x40, 0x78, 0x40, 0x7C}, // 0xF8'ш'
-	{0x7C, 0x40, 0x78, 0x40, 0xFC}, // 0xF9'щ'
-	{0x04, 0x7C, 0x50, 0x50, 0x20}, // 0xFA'ъ'
-	{0x7C, 0x50, 0x50, 0x20, 0x7C}, // 0xFB'ы'
-	{0x7C, 0x50, 0x50, 0x20, 0x00}, // 0xFC'ь'
-	{0x00, 0x44, 0x44, 0x54, 0x38}, // 0xFD'э'
-	{0x7C, 0x10, 0x38, 0x44, 0x38}, // 0xFE'ю'
-	{0x48, 0x34, 0x14, 0x7C, 0x00}, // 0xFF'я'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // U+0020 ' '
+	{0x00, 0x00, 0x5E, 0x00, 0x00, 0x00}, // U+0021 '!'
+	{0x00, 0x06, 0x00, 0x06, 0x00, 0x00}, // U+0022 '"'
+	{0x24, 0x7E, 0x24, 0x7E, 0x24, 0x00}, // U+0023 '#'
+	{0x08, 0x54, 0xD6, 0x54, 0x20, 0x00}, // U+0024 '$'
+	{0x44, 0x20, 0x10, 0x08, 0x44, 0x00}, // U+0025 '%'
+	{0x34, 0x4A, 0x54, 0x20, 0x50, 0x00}, // U+0026 '&'
+	{0x00, 0x00, 0x06, 0x00, 0x00, 0x00}, // U+0027 '''
+	{0x00, 0x3C, 0x42, 0x00, 0x00, 0x00}, // U+0028 '('
+	{0x00, 0x00, 0x42, 0x3C, 0x00, 0x00}, // U+0029 ')'
+	{0x00, 0x14, 0x08, 0x14, 0x00, 0x00}, // U+002A '*'
+	{0x10, 0x10, 0x7C, 0x10, 0x10, 0x00}, // U+002B '+'
+	{0x00, 0x80, 0x40, 0x00, 0x00, 0x00}, // U+002C ','
+	{0x10, 0x10, 0x10, 0x10, 0x00, 0x00}, // U+002D '-'
+	{0x00, 0x00, 0x40, 0x00, 0x00, 0x00}, // U+002E '.'
+	{0x00, 0x60, 0x18, 0x06, 0x00, 0x00}, // U+002F '/'
+	{0x3C, 0x62, 0x5A, 0x46, 0x3C, 0x00}, // U+0030 '0'
+	{0x00, 0x08, 0x04, 0x7E, 0x00, 0x00}, // U+0031 '1'
+	{0x64, 0x52, 0x52, 0x52, 0x4C, 0x00}, // U+0032 '2'
+	{0x24, 0x42, 0x4A, 0x4A, 0x34, 0x00}, // U+0033 '3'
+	{0x1E, 0x10, 0x10, 0x10, 0x7E, 0x00}, // U+0034 '4'
+	{0x26, 0x4A, 0x4A, 0x4A, 0x32, 0x00}, // U+0035 '5'
+	{0x3C, 0x4A, 0x4A, 0x4A, 0x30, 0x00}, // U+0036 '6'
+	{0x02, 0x02, 0x72, 0x0A, 0x06, 0x00}, // U+0037 '7'
+	{0x34, 0x4A, 0x4A, 0x4A, 0x34, 0x00}, // U+0038 '8'
+	{0x0C, 0x52, 0x52, 0x52, 0x3C, 0x00}, // U+0039 '9'
+	{0x00, 0x00, 0x44, 0x00, 0x00, 0x00}, // U+003A ':'
+	{0x00, 0x80, 0x44, 0x00, 0x00, 0x00}, // U+003B ';'
+	{0x00, 0x10, 0x28, 0x44, 0x00, 0x00}, // U+003C '<'
+	{0x00, 0x28, 0x28, 0x28, 0x00, 0x00}, // U+003D '='
+	{0x00, 0x44, 0x28, 0x10, 0x00, 0x00}, // U+003E '>'
+	{0x00, 0x02, 0x5A, 0x04, 0x00, 0x00}, // U+003F '?'
+	{0x3C, 0x42, 0x5A, 0x52, 0x0C, 0x00}, // U+0040 '@'
+	{0x7C, 0x12, 0x12, 0x12, 0x7C, 0x00}, // U+0041 'A'
+	{0x7E, 0x4A, 0x4A, 0x4A, 0x34, 0x00}, // U+0042 'B'
+	{0x3C, 0x42, 0x42, 0x42, 0x24, 0x00}, // U+0043 'C'
+	{0x7E, 0x42, 0x42, 0x42, 0x3C, 0x00}, // U+0044 'D'
+	{0x7E, 0x4A, 0x4A, 0x42, 0x42, 0x00}, // U+0045 'E'
+	{0x7E, 0x0A, 0x0A, 0x0A, 0x02, 0x00}, // U+0046 'F'
+	{0x3C, 0x42, 0x52, 0x52, 0x34, 0x00}, // U+0047 'G'
+	{0x7E, 0x08, 0x08, 0x08, 0x7E, 0x00}, // U+0048 'H'
+	{0x42, 0x42, 0x7E, 0x42, 0x42, 0x00}, // U+0049 'I'
+	{0x42, 0x42, 0x3E, 0x02, 0x02, 0x00}, // U+004A 'J'
+	{0x7E, 0x08, 0x08, 0x14, 0x62, 0x00}, // U+004B 'K'
+	{0x7E, 0x40, 0x40, 0x40, 0x40, 0x00}, // U+004C 'L'
+	{0x7E, 0x04, 0x18, 0x04, 0x7E, 0x00}, // U+004D 'M'
+	{0x7E, 0x04, 0x08, 0x10, 0x7E, 0x00}, // U+004E 'N'
+	{0x3C, 0x42, 0x42, 0x42, 0x3C, 0x00}, // U+004F 'O'
+	{0x7E, 0x12, 0x12, 0x12, 0x0C, 0x00}, // U+0050 'P'
+	{0x3C, 0x42, 0x42, 0x42, 0xBC, 0x00}, // U+0051 'Q'
+	{0x7E, 0x12, 0x12, 0x12, 0x6C, 0x00}, // U+0052 'R'
+	{0x24, 0x4A, 0x4A, 0x52, 0x24, 0x00}, // U+0053 'S'
+	{0x02, 0x02, 0x7E, 0x02, 0x02, 0x00}, // U+0054 'T'
+	{0x3E, 0x40, 0x40, 0x40, 0x3E, 0x00}, // U+0055 'U'
+	{0x06, 0x18, 0x60, 0x18, 0x06, 0x00}, // U+0056 'V'
+	{0x3E, 0x40, 0x30, 0x40, 0x3E, 0x00}, // U+0057 'W'
+	{0x42, 0x24, 0x18, 0x24, 0x42, 0x00}, // U+0058 'X'
+	{0x06, 0x08, 0x70, 0x08, 0x06, 0x00}, // U+0059 'Y'
+	{0x62, 0x52, 0x4A, 0x46, 0x42, 0x00}, // U+005A 'Z'
+	{0x00, 0x7E, 0x42, 0x00, 0x00, 0x00}, // U+005B '['
+	{0x00, 0x06, 0x18, 0x60, 0x00, 0x00}, // U+005C '\'
+	{0x00, 0x00, 0x42, 0x7E, 0x00, 0x00}, // U+005D ']'
+	{0x00, 0x04, 0x02, 0x04, 0x00, 0x00}, // U+005E '^'
+	{0x40, 0x40, 0x40, 0x40, 0x40, 0x00}, // U+005F '_'
+	{0x00, 0x02, 0x04, 0x00, 0x00, 0x00}, // U+0060 '`'
+	{0x20, 0x54, 0x54, 0x78, 0x00, 0x00}, // U+0061 'a'
+	{0x7E, 0x48, 0x48, 0x30, 0x00, 0x00}, // U+0062 'b'
+	{0x38, 0x44, 0x44, 0x28, 0x00, 0x00}, // U+0063 'c'
+	{0x30, 0x48, 0x48, 0x7E, 0x00, 0x00}, // U+0064 'd'
+	{0x38, 0x54, 0x54, 0x18, 0x00, 0x00}, // U+0065 'e'
+	{0x10, 0x7C, 0x12, 0x02, 0x00, 0x00}, // U+0066 'f'
+	{0x18, 0xA4, 0xA4, 0x78, 0x00, 0x00}, // U+0067 'g'
+	{0x7E, 0x08, 0x08, 0x70, 0x00, 0x00}, // U+0068 'h'
+	{0x00, 0x00, 0x7A, 0x00, 0x00, 0x00}, // U+0069 'i'
+	{0x80, 0x80, 0x7A, 0x00, 0x00, 0x00}, // U+006A 'j'
+	{0x7E, 0x10, 0x28, 0x40, 0x00, 0x00}, // U+006B 'k'
+	{0x00, 0x00, 0x3E, 0x40, 0x00, 0x00}, // U+006C 'l'
+	{0x7C, 0x04, 0x18, 0x04, 0x78, 0x00}, // U+006D 'm'
+	{0x7C, 0x08, 0x04, 0x78, 0x00, 0x00}, // U+006E 'n'
+	{0x38, 0x44, 0x44, 0x38, 0x00, 0x00}, // U+006F 'o'
+	{0xFC, 0x24, 0x24, 0x18, 0x00, 0x00}, // U+0070 'p'
+	{0x18, 0x24, 0x24, 0xFC, 0x00, 0x00}, // U+0071 'q'
+	{0x7C, 0x08, 0x04, 0x04, 0x00, 0x00}, // U+0072 'r'
+	{0x48, 0x54, 0x54, 0x24, 0x00, 0x00}, // U+0073 's'
+	{0x08, 0x3E, 0x48, 0x40, 0x00, 0x00}, // U+0074 't'
+	{0x3C, 0x40, 0x40, 0x3C, 0x00, 0x00}, // U+0075 'u'
+	{0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00}, // U+0076 'v'
+	{0x3C, 0x40, 0x30, 0x40, 0x3C, 0x00}, // U+0077 'w'
+	{0x44, 0x28, 0x10, 0x28, 0x44, 0x00}, // U+0078 'x'
+	{0x1C, 0xA0, 0xA0, 0x7C, 0x00, 0x00}, // U+0079 'y'
+	{0x44, 0x64, 0x54, 0x4C, 0x00, 0x00}, // U+007A 'z'
+	{0x10, 0x6C, 0x82, 0x00, 0x00, 0x00}, // U+007B '{'
+	{0x00, 0x00, 0xFE, 0x00, 0x00, 0x00}, // U+007C '|'
+	{0x00, 0x00, 0x82, 0x6C, 0x10, 0x00}, // U+007D '}'
+	{0x08, 0x04, 0x0C, 0x08, 0x04, 0x00}, // U+007E '~'
+	{0x00, 0x06, 0x09, 0x09, 0x06, 0x00}, // U+00B0 '°'
+	{0x7C, 0x55, 0x54, 0x55, 0x44, 0x00}, // U+0401 'Ё'
+	{0x78, 0x14, 0x12, 0x14, 0x78, 0x00}, // U+0410 'А'
+	{0x7E, 0x4A, 0x4A, 0x4A, 0x30, 0x00}, // U+0411 'Б'
+	{0x7E, 0x4A, 0x4A, 0x4C, 0x30, 0x00}, // U+0412 'В'
+	{0x7E, 0x02, 0x02, 0x02, 0x02, 0x00}, // U+0413 'Г'
+	{0x60, 0x3C, 0x22, 0x3E, 0x60, 0x00}, // U+0414 'Д'
+	{0x7E, 0x4A, 0x4A, 0x42, 0x42, 0x00}, // U+0415 'Е'
+	{0x66, 0x18, 0x7E, 0x18, 0x66, 0x00}, // U+0416 'Ж'
+	{0x42, 0x42, 0x4A, 0x4A, 0x34, 0x00}, // U+0417 'З'
+	{0x7E, 0x10, 0x08, 0x04, 0x7E, 0x00}, // U+0418 'И'
+	{0x7E, 0x10, 0x09, 0x04, 0x7E, 0x00}, // U+0419 'Й'
+	{0x7E, 0x10, 0x08, 0x14, 0x62, 0x00}, // U+041A 'К'
+	{0x40, 0x3C, 0x02, 0x02, 0x7E, 0x00}, // U+041B 'Л'
+	{0x7E, 0x04, 0x08, 0x04, 0x7E, 0x00}, // U+041C 'М'
+	{0x7E, 0x08, 0x08, 0x08, 0x7E, 0x00}, // U+041D 'Н'
+	{0x3C, 0x42, 0x42, 0x42, 0x3C, 0x00}, // U+041E 'О'
+	{0x7E, 0x02, 0x02, 0x02, 0x7E, 0x00}, // U+041F 'П'
+	{0x7E, 0x12, 0x12, 0x12, 0x0C, 0x00}, // U+0420 'Р'
+	{0x3C, 0x42, 0x42, 0x42, 0x24, 0x00}, // U+0421 'С'
+	{0x02, 0x02, 0x7E, 0x02, 0x02, 0x00}, // U+0422 'Т'
+	{0x46, 0x28, 0x10, 0x08, 0x06, 0x00}, // U+0423 'У'
+	{0x1C, 0x22, 0x7E, 0x22, 0x1C, 0x00}, // U+0424 'Ф'
+	{0x42, 0x24, 0x18, 0x24, 0x42, 0x00}, // U+0425 'Х'
+	{0x7E, 0x40, 0x40, 0x7E, 0xC0, 0x00}, // U+0426 'Ц'
+	{0x0E, 0x10, 0x10, 0x10, 0x7E, 0x00}, // U+0427 'Ч'
+	{0x7E, 0x40, 0x7C, 0x40, 0x7E, 0x00}, // U+0428 'Ш'
+	{0x7E, 0x40, 0x7C, 0x40, 0xFE, 0x00}, // U+0429 'Щ'
+	{0x02, 0x7E, 0x48, 0x48, 0x30, 0x00}, // U+042A 'Ъ'
+	{0x7E, 0x48, 0x30, 0x00, 0x7E, 0x00}, // U+042B 'Ы'
+	{0x7E, 0x48, 0x48, 0x48, 0x30, 0x00}, // U+042C 'Ь'
+	{0x42, 0x4A, 0x4A, 0x4A, 0x3C, 0x00}, // U+042D 'Э'
+	{0x7E, 0x08, 0x3C, 0x42, 0x3C, 0x00}, // U+042E 'Ю'
+	{0x4C, 0x52, 0x32, 0x12, 0x7E, 0x00}, // U+042F 'Я'
+	{0x20, 0x54, 0x54, 0x78, 0x00, 0x00}, // U+0430 'а'
+	{0x7C, 0x54, 0x54, 0x20, 0x00, 0x00}, // U+0431 'б'
+	{0x7C, 0x54, 0x54, 0x28, 0x00, 0x00}, // U+0432 'в'
+	{0x7C, 0x04, 0x04, 0x04, 0x00, 0x00}, // U+0433 'г'
+	{0xC0, 0x78, 0x44, 0x7C, 0xC0, 0x00}, // U+0434 'д'
+	{0x38, 0x54, 0x54, 0x18, 0x00, 0x00}, // U+0435 'е'
+	{0x64, 0x18, 0x7C, 0x18, 0x64, 0x00}, // U+0436 'ж'
+	{0x00, 0x44, 0x54, 0x54, 0x28, 0x00}, // U+0437 'з'
+	{0x7C, 0x20, 0x10, 0x7C, 0x00, 0x00}, // U+0438 'и'
+	{0x78, 0x22, 0x12, 0x78, 0x00, 0x00}, // U+0439 'й'
+	{0x7C, 0x10, 0x28, 0x44, 0x00, 0x00}, // U+043A 'к'
+	{0x40, 0x3C, 0x04, 0x7C, 0x00, 0x00}, // U+043B 'л'
+	{0x7C, 0x08, 0x10, 0x08, 0x7C, 0x00}, // U+043C 'м'
+	{0x7C, 0x10, 0x10, 0x7C, 0x00, 0x00}, // U+043D 'н'
+	{0x38, 0x44, 0x44, 0x38, 0x00, 0x00}, // U+043E 'о'
+	{0x7C, 0x04, 0x04, 0x7C, 0x00, 0x00}, // U+043F 'п'
+	{0xFC, 0x24, 0x24, 0x18, 0x00, 0x00}, // U+0440 'р'
+	{0x38, 0x44, 0x44, 0x28, 0x00, 0x00}, // U+0441 'с'
+	{0x00, 0x04, 0x7C, 0x04, 0x00, 0x00}, // U+0442 'т'
+	{0x44, 0x28, 0x10, 0x08, 0x04, 0x00}, // U+0443 'у'
+	{0x30, 0x48, 0xFC, 0x48, 0x30, 0x00}, // U+0444 'ф'
+	{0x44, 0x28, 0x10, 0x28, 0x44, 0x00}, // U+0445 'х'
+	{0x7C, 0x40, 0x40, 0x7C, 0x80, 0x00}, // U+0446 'ц'
+	{0x0C, 0x10, 0x10, 0x7C, 0x00, 0x00}, // U+0447 'ч'
+	{0x7C, 0x40, 0x78, 0x40, 0x7C, 0x00}, // U+0448 'ш'
+	{0x7C, 0x40, 0x78, 0x40, 0xFC, 0x00}, // U+0449 'щ'
+	{0x04, 0x7C, 0x50, 0x50, 0x20, 0x00}, // U+044A 'ъ'
+	{0x7C, 0x50, 0x50, 0x20, 0x7C, 0x00}, // U+044B 'ы'
+	{0x7C, 0x50, 0x50, 0x20, 0x00, 0x00}, // U+044C 'ь'
+	{0x00, 0x44, 0x44, 0x54, 0x38, 0x00}, // U+044D 'э'
+	{0x7C, 0x10, 0x38, 0x44, 0x38, 0x00}, // U+044E 'ю'
+	{0x48, 0x34, 0x14, 0x7C, 0x00, 0x00}, // U+044F 'я'
+	{0x38, 0x55, 0x54, 0x19, 0x00, 0x00}, // U+0451 'ё'
+};
+
+/*
+ * Unicode to lcd_chars6x8 index mapping, sorted by codepoint
+ */
+const glyph_range_t lcd_chars6x8_ranges[] = {
+	{0x0020,  95,   0}, // ' '..'~'
+	{0x00A0,   1,   0}, // ' '
+	{0x00B0,   1,  95}, // '°'
+	{0x0401,   1,  96}, // 'Ё'
+	{0x0410,  64,  97}, // 'А'..'я'
+	{0x0451,   1, 161}, // 'ё'
 };
 
+#define LCD_CHARS6X8_RANGES   6
+#define LCD_CHARS6X8_FALLBACK 31 // shown for chars missing in font
 
-#endif /* LCD_CHARS_H_ */
+#endif /* LCD_CHARS6X8_H_ */
@@ -0,0 +1,104 @@
+/*
+ * lcd_driver.h
+ *
+ *  Display controller abstraction. All supported panels store pixels in 8-pixel high
+ *  pages of vertical bytes (LSB on top), so framebuffer and text console code in
+ *  lcd_nokia.c are the same for all of them, and only the transport differs.
+ *
+ *  Backends:
+ *  lcd_nokia1100_driver -- Nokia 1100/1110/1202 (PCF8814/STE2007), 9-bit SPI, 96x68
+ *  lcd_pcd8544_driver   -- Nokia 5110/3310 (PCD8544), 4-wire SPI with D/C line, 84x48
+ *  lcd_ssd1306_driver   -- SSD1306 OLED, 4-wire SPI with D/C line, 128x64
+ */
+
+#ifndef LCD_DRIVER_H_
+#define LCD_DRIVER_H_
+
+#include <stddef.h>
+
+#include "lcd_spi.h"
+
+/*
+ * biggest geometry of supported panels, for static framebuffer allocation
+ */
+#define LCD_MAX_WIDTH 128
+#define LCD_MAX_PAGES 9
+
+/*
+ * \brief framebuffer size in bytes for panel of given geometry
+ */
+#define LCD_FRAMEBUFFER_SIZE(geometry) ((geometry)->width * (((geometry)->height + 7) >> 3))
+
+/*
+ * \brief display power modes. Controller RAM is kept in all of them.
+ */
+typedef enum {
+	LCD_POWER_ON = 0,     // normal operation, shows RAM contents
+	LCD_POWER_SLEEP = 1,  // display off, controller in power save mode, lowest current
+	LCD_POWER_ALL_OFF = 2,// all pixels off, controller running
+	LCD_POWER_ALL_ON = 3  // all pixels on, controller running
+} lcd_power_t;
+
+/*
+ * \brief panel geometry descriptor
+ */
+typedef struct {
+	uint8_t width;  // in pixels, also length of page in bytes, multiple of 4
+	uint8_t height; // in pixels, last page may be incomplete
+} lcd_geometry_t;
+
+/*
+ * \brief display controller backend
+ */
+typedef struct {
+	lcd_geometry_t geometry;
+
+	/*
+	 * \brief configure hardware, reset controller and send its init sequence. Done in steps
+	 *        split by delays, so caller may do something else meanwhile: called with
+	 *        step 0, 1... until it returns 0
+	 * \return milliseconds to wait before the next step, 0 if init is done
+	 */
+	uint32_t (*init)(int step);
+
+	/*
+	 * \brief set address, where next data will be written
+	 * \param page 8-pixel row
+	 * \param column pixel column
+	 */
+	void (*set_address)(uint8_t page, uint8_t column);
+
+	/*
+	 * \brief write data bytes starting at current address. May return before data is sent,
+	 *        so buffer must not change until next driver call.
+	 */
+	void (*write_data)(const uint8_t *data, int length);
+
+	/*
+	 * \brief write the same data byte length times starting at current address
+	 */
+	void (*fill)(uint8_t value, int length);
+
+	/*
+	 * \brief write controller command byte
+	 */
+	void (*write_command)(uint8_t command);
+
+	/*
+	 * \brief switch power mode, see lcd_power_t
+	 */
+	void (*set_power)(lcd_power_t mode);
+
+	/*
+	 * \brief drive only given pages, rest of display is dark. NULL if controller can't.
+	 * \param pages number of pages, 0 for whole display
+	 * \return 0 if successful, -1 if controller can't drive this range: nothing is changed
+	 */
+	int (*set_partial)(uint8_t first_page, uint8_t pages);
+} lcd_driver_t;
+
+extern const lcd_driver_t lcd_nokia1100_driver;
+extern const lcd_driver_t lcd_pcd8544_driver;
+extern const lcd_driver_t lcd_ssd1306_driver;
+
+#endif /* LCD_DRIVER_H_ */
@@ -0,0 +1,105 @@
+/*
+ * lcd_drv_nokia1100.c
+ *
+ *  Nokia 1100, 1110, 1110i, 1202 display backend.
+ *  Controller takes 9-bit frames, bit 8 selects data (1) or command (0). DMA can't add
+ *  that bit on the fly, so bulk data is pushed through SPI FIFO by CPU.
+ */
+
+#include "lcd_driver.h"
+
+const uint8_t lcd_init_sequence[] = {
+	0xEB, // Thermal comp. on
+	0x2F, // Supply mode
+	0xA1, // Horisontal reverse: Reverse - 0xA9, Normal - 0xA1
+//	0xC9, // Vertical reverse (comment if no need)
+	0xA6, // Positive - A7, Negative - A6
+	0x90, // Contrast 0x90...0x9F
+	0xEC, // Set refresh rate to 80 Hz
+	0xAF, // Enable LCD
+	0xA4  // Display all points normal
+};
+
+static void nokia1100_write_command(uint8_t command)
+{
+	lcd_spi_send(command);
+}
+
+static RAMFUNC void nokia1100_write_data(const uint8_t *data, int length)
+{
+	int i;
+	for(i = 0; i < length; i++)
+		lcd_spi_send(data[i] | 0x100);
+}
+
+static RAMFUNC void nokia1100_fill(uint8_t value, int length)
+{
+	while(length--)
+		lcd_spi_send(value | 0x100);
+}
+
+static void nokia1100_set_address(uint8_t page, uint8_t column)
+{
+	lcd_spi_send(0xB0 | page);
+	lcd_spi_send(0x10 | (column >> 4));
+	lcd_spi_send(column & 0x0F);
+}
+
+/*
+ * command sequences for lcd_power_t modes.
+ * power save is display off followed by all points on, as for SED15xx controllers
+ */
+const uint8_t lcd_nokia1100_power_sequences[][2] = {
+	{ 0xA4, 0xAF }, // LCD_POWER_ON: all points normal, display on
+	{ 0xAE, 0xA5 }, // LCD_POWER_SLEEP: display off, all points on
+	{ 0xA4, 0xAE }, // LCD_POWER_ALL_OFF: all points normal, display off
+	{ 0xAF, 0xA5 }  // LCD_POWER_ALL_ON: display on, all points on
+};
+
+static void nokia1100_set_power(lcd_power_t mode)
+{
+	nokia1100_write_command(lcd_nokia1100_power_sequences[mode][0]);
+	nokia1100_write_command(lcd_nokia1100_power_sequences[mode][1]);
+}
+
+static uint32_t nokia1100_init(int step)
+{
+	uint16_t i;
+
+	if(step == 0) {
+		lcd_spi_init(SPI_DataSize_9b);
+		return LCD_SPI_RESET_MS;
+	}
+	if(step == 1) {
+		lcd_spi_reset_done();
+
+//	// send Reading Mode command
+//	lcd_write_command(0xdb);
+//	// switch SPI to read
+//	SPI_BiDirectionalLineConfig(LCD_SPI, SPI_Direction_Rx);
+//	while(SPI_GetReceptionFIFOStatus(LCD_SPI) < SPI_ReceptionFIFOStatus_HalfFull);
+//	data = SPI_I2S_ReceiveData16(LCD_SPI);
+//	// switch SPI back to write
+//	SPI_BiDirectionalLineConfig(LCD_SPI, SPI_Direction_Tx);
+
+		// send command of internal display reset
+		nokia1100_write_command(0xE2);
+		// wait...
+		return 20;
+	}
+	// send init commands to display
+	for(i = 0; i < sizeof(lcd_init_sequence); i++)
+		nokia1100_write_command(lcd_init_sequence[i]);
+	return 0;
+}
+
+const lcd_driver_t lcd_nokia1100_driver = {
+	{ 96, 68 },
+	nokia1100_init,
+	nokia1100_set_address,
+	nokia1100_write_data,
+	nokia1100_fill,
+	nokia1100_write_command,
+	nokia1100_set_power,
+	NULL // no partial display mode
+};
@@ -0,0 +1,85 @@
+/*
+ * lcd_drv_pcd8544.c
+ *
+ *  PCD8544 (Nokia 5110, 3310) display backend. 8-bit SPI with separate D/C line,
+ *  so bulk data goes straight from framebuffer to SPI by DMA.
+ */
+
+#include "lcd_driver.h"
+
+const uint8_t lcd_pcd8544_init_sequence[] = {
+	0x21, // Function set: extended instruction set
+	0xB8, // Vop (contrast) 0x80...0xFF
+	0x04, // Temperature coefficient 0
+	0x14, // Bias 1:48
+	0x20, // Function set: basic instruction set, horizontal addressing
+	0x0C  // Display control: normal mode
+};
+
+static void pcd8544_write_command(uint8_t command)
+{
+	lcd_spi_set_dc(0);
+	lcd_spi_send(command);
+}
+
+static void pcd8544_write_data(const uint8_t *data, int length)
+{
+	lcd_spi_set_dc(1);
+	lcd_spi_write(data, length);
+}
+
+static void pcd8544_fill(uint8_t value, int length)
+{
+	lcd_spi_set_dc(1);
+	lcd_spi_fill(value, length);
+}
+
+static void pcd8544_set_address(uint8_t page, uint8_t column)
+{
+	lcd_spi_set_dc(0);
+	lcd_spi_send(0x40 | page);
+	lcd_spi_send(0x80 | column);
+}
+
+/*
+ * command sequences for lcd_power_t modes: function set, then display control
+ */
+const uint8_t lcd_pcd8544_power_sequences[][2] = {
+	{ 0x20, 0x0C }, // LCD_POWER_ON: chip active, normal mode
+	{ 0x24, 0x08 }, // LCD_POWER_SLEEP: power down, display blank
+	{ 0x20, 0x08 }, // LCD_POWER_ALL_OFF: chip active, display blank
+	{ 0x20, 0x09 }  // LCD_POWER_ALL_ON: chip active, all segments on
+};
+
+static void pcd8544_set_power(lcd_power_t mode)
+{
+	lcd_spi_set_dc(0);
+	lcd_spi_send(lcd_pcd8544_power_sequences[mode][0]);
+	lcd_spi_send(lcd_pcd8544_power_sequences[mode][1]);
+}
+
+static uint32_t pcd8544_init(int step)
+{
+	uint16_t i;
+
+	if(step == 0) {
+		lcd_spi_init(SPI_DataSize_8b);
+		return LCD_SPI_RESET_MS;
+	}
+	lcd_spi_reset_done();
+	lcd_spi_set_dc(0);
+	for(i = 0; i < sizeof(lcd_pcd8544_init_sequence); i++)
+		lcd_spi_send(lcd_pcd8544_init_sequence[i]);
+	return 0;
+}
+
+const lcd_driver_t lcd_pcd8544_driver = {
+	{ 84, 48 },
+	pcd8544_init,
+	pcd8544_set_address,
+	pcd8544_write_data,
+	pcd8544_fill,
+	pcd8544_write_command,
+	pcd8544_set_power,
+	NULL // no partial display mode
+};
@@ -0,0 +1,120 @@
+/*
+ * lcd_drv_ssd1306.c
+ *
+ *  SSD1306 128x64 OLED display backend, 4-wire SPI mode (D/C line, CS tied low).
+ *  Controller is switched to horizontal addressing, so writes wrap to the next page
+ *  like on Nokia displays, and whole framebuffer goes by single DMA transfer.
+ */
+
+#include "lcd_driver.h"
+
+const uint8_t lcd_ssd1306_init_sequence[] = {
+	0xAE,       // Display off
+	0xD5, 0x80, // Clock divider and oscillator frequency
+	0xA8, 0x3F, // Multiplex ratio: 64 rows
+	0xD3, 0x00, // Display offset 0
+	0x40,       // Display start line 0
+	0x8D, 0x14, // Charge pump on
+	0x20, 0x00, // Horizontal addressing mode
+	0xA1,       // Segment remap: column 127 is SEG0
+	0xC8,       // COM scan direction: remapped
+	0xDA, 0x12, // COM pins: alternative configuration
+	0x81, 0xCF, // Contrast
+	0xD9, 0xF1, // Precharge period
+	0xDB, 0x40, // VCOMH deselect level
+	0xA4,       // Display all points normal
+	0xA6,       // Positive
+	0xAF        // Display on
+};
+
+static void ssd1306_write_command(uint8_t command)
+{
+	lcd_spi_set_dc(0);
+	lcd_spi_send(command);
+}
+
+static void ssd1306_write_data(const uint8_t *data, int length)
+{
+	lcd_spi_set_dc(1);
+	lcd_spi_write(data, length);
+}
+
+static void ssd1306_fill(uint8_t value, int length)
+{
+	lcd_spi_set_dc(1);
+	lcd_spi_fill(value, length);
+}
+
+static void ssd1306_set_address(uint8_t page, uint8_t column)
+{
+	lcd_spi_set_dc(0);
+	// column and page ranges, rest of the screen
+	lcd_spi_send(0x21);
+	lcd_spi_send(column);
+	lcd_spi_send(127);
+	lcd_spi_send(0x22);
+	lcd_spi_send(page);
+	lcd_spi_send(7);
+}
+
+/*
+ * command sequences for lcd_power_t modes: charge pump, display on/off, all points
+ */
+const uint8_t lcd_ssd1306_power_sequences[][4] = {
+	{ 0x8D, 0x14, 0xAF, 0xA4 }, // LCD_POWER_ON: charge pump on, display on, follow RAM
+	{ 0xAE, 0x8D, 0x10, 0xA4 }, // LCD_POWER_SLEEP: display off, charge pump off
+	{ 0x8D, 0x14, 0xAE, 0xA4 }, // LCD_POWER_ALL_OFF: display off, charge pump stays on
+	{ 0x8D, 0x14, 0xAF, 0xA5 }  // LCD_POWER_ALL_ON: display on, entire display on
+};
+
+static void ssd1306_set_power(lcd_power_t mode)
+{
+	int i;
+	lcd_spi_set_dc(0);
+	for(i = 0; i < 4; i++)
+		lcd_spi_send(lcd_ssd1306_power_sequences[mode][i]);
+}
+
+static int ssd1306_set_partial(uint8_t first_page, uint8_t pages)
+{
+	if(pages == 0) {
+		first_page = 0;
+		pages = 8;
+	}
+	// MUX ratio is 16..64 rows, and range past COM63 would map rows which don't exist
+	if(pages < 2 || first_page + pages > 8)
+		return -1;
+	// fewer multiplexed rows means lower current
+	lcd_spi_set_dc(0);
+	lcd_spi_send(0xA8);
+	lcd_spi_send(pages * 8 - 1);
+	lcd_spi_send(0xD3);
+	lcd_spi_send(first_page * 8);
+	return 0;
+}
+
+static uint32_t ssd1306_init(int step)
+{
+	uint16_t i;
+
+	if(step == 0) {
+		lcd_spi_init(SPI_DataSize_8b);
+		return LCD_SPI_RESET_MS;
+	}
+	lcd_spi_reset_done();
+	lcd_spi_set_dc(0);
+	for(i = 0; i < sizeof(lcd_ssd1306_init_sequence); i++)
+		lcd_spi_send(lcd_ssd1306_init_sequence[i]);
+	return 0;
+}
+
+const lcd_driver_t lcd_ssd1306_driver = {
+	{ 128, 64 },
+	ssd1306_init,
+	ssd1306_set_address,
+	ssd1306_write_data,
+	ssd1306_fill,
+	ssd1306_write_command,
+	ssd1306_set_power,
+	ssd1306_set_partial
+};
@@ -0,0 +1,42 @@
+/*
+ * lcd_mem.c
+ */
+
+#include "lcd_mem.h"
+
+void lcd_fill32(uint32_t *dst, uint32_t value, int words)
+{
+	uint32_t *end = dst + words;
+
+	// 4 words per iteration, compiles to single STM on Cortex-M0
+	while(end - dst >= 4)
+	{
+		dst[0] = value;
+		dst[1] = value;
+		dst[2] = value;
+		dst[3] = value;
+		dst += 4;
+	}
+	while(dst < end)
+		*dst++ = value;
+}
+
+void lcd_move32(uint32_t *dst, const uint32_t *src, int words)
+{
+	uint32_t *end = dst + words;
+
+	// 4 words per iteration, LDM/STM pair. all words are loaded before storing,
+	// so areas closer than 4 words are moved correctly too
+	while(end - dst >= 4)
+	{
+		uint32_t a = src[0], b = src[1], c = src[2], d = src[3];
+		dst[0] = a;
+		dst[1] = b;
+		dst[2] = c;
+		dst[3] = d;
+		dst += 4;
+		src += 4;
+	}
+	while(dst < end)
+		*dst++ = *src++;
+}
@@ -0,0 +1,29 @@
+/*
+ * lcd_mem.h
+ *
+ *  Word-wide memory operations for framebuffer clearing and scrolling.
+ *  No hardware dependencies, so they can be tested on host, see test/lcd_test.c
+ */
+
+#ifndef LCD_MEM_H_
+#define LCD_MEM_H_
+
+#include <stdint.h>
+
+/*
+ * \brief Fill memory with 32-bit value
+ * \param dst word aligned destination
+ * \param value fill pattern, 0 to clear
+ * \param words number of 32-bit words
+ */
+void lcd_fill32(uint32_t *dst, uint32_t value, int words);
+
+/*
+ * \brief Move memory towards lower addresses, areas may overlap
+ * \param dst word aligned destination, must not be above src
+ * \param src word aligned source
+ * \param words number of 32-bit words
+ */
+void lcd_move32(uint32_t *dst, const uint32_t *src, int words);
+
+#endif /* LCD_MEM_H_ */
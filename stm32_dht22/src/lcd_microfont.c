@@ -0,0 +1,132 @@
+/*
+ * lcd_microfont.c
+ */
+
+#include "lcd_microfont.h"
+
+/*
+ * set or clear pixel of glyph cell, y is counted from top of column
+ */
+static inline void lcd_mf_set_pixel(uint8_t *column, int y, uint32_t pixel)
+{
+	uint8_t *p = column + (y >> 3) * lcd_state.width, mask = 1 << (y & 7);
+	if(pixel)
+		*p |= mask;
+	else
+		*p &= ~mask;
+}
+
+/*
+ * glyphs with box: clear whole cell, only box is drawn then. empty columns cost nothing
+ * \return address of box left column
+ */
+static uint8_t *lcd_mf_box(const microfont_t *font, const mf_reader_t *reader, uint8_t *cell, int width)
+{
+	uint8_t *p, mask;
+	int x, y;
+
+	if(font->flags & MF_FLAG_BOX)
+		for(y = 0, p = cell; y < font->height; y += 8, p += lcd_state.width)
+		{
+			// rows below font height belong to the next line, keep them
+			mask = font->height - y >= 8 ? 0 : 0xFF << (font->height - y);
+			for(x = 0; x < width; x++)
+				p[x] &= mask;
+		}
+	return cell + reader->box_x;
+}
+
+/*
+ * move cursor to the beginning of next line of font, scroll or wrap if it doesn't fit
+ */
+static void lcd_mf_newline(int pages)
+{
+	uint8_t line = lcd_state.current_line + pages;
+
+	if(line + pages > lcd_state.lines) {
+		// scroll or wrap, depending if we have a framebuffer and scrolling state
+		if((lcd_state.flags & LCD_FLAG_SCROLL) && pages <= lcd_state.lines)
+			for(; line + pages > lcd_state.lines; line--)
+				lcd_scroll();
+		else
+			line = 0;
+	}
+	lcd_set_cursor(line, 0);
+}
+
+int lcd_mf_putc(const microfont_t *font, uint32_t c)
+{
+	mf_reader_t reader;
+	uint16_t offset = mf_find_glyph(font, c);
+	int x, y, width, pages = (font->height + 7) >> 3;
+	uint8_t line, column, *dest;
+	const uint8_t *src;
+
+	if(offset == MF_EMPTY_CHAR || lcd_state.framebuffer == NULL)
+		return 0;
+	width = mf_read_init(&reader, font, offset);
+	if(lcd_state.current_column + width > lcd_state.width)
+		lcd_mf_newline(pages);
+	line = lcd_state.current_line;
+	column = lcd_state.current_column;
+	if(line + pages > lcd_state.pages || width > lcd_state.width)
+		return 0; // font is too big for display
+
+	dest = lcd_state.framebuffer + line * lcd_state.width + column;
+	switch(font->flags & MF_FLAG_ORDER)
+	{
+	case MF_ORDER_PAGES:
+		// same layout as display memory: straight copy, whole pages
+		src = mf_read_pages(&reader);
+		for(y = 0; y < pages; y++, dest += lcd_state.width)
+			for(x = 0; x < width; x++)
+				dest[x] = *src++;
+		break;
+	case MF_ORDER_ROWS:
+		dest = lcd_mf_box(font, &reader, dest, width);
+		for(y = 0; y < reader.box_height; y++)
+			for(x = 0; x < reader.box_width; x++)
+				lcd_mf_set_pixel(dest + x, reader.box_y + y, mf_read_pixel(&reader));
+		break;
+	default:
+		// by columns, top to bottom
+		dest = lcd_mf_box(font, &reader, dest, width);
+		for(x = 0; x < reader.box_width; x++, dest++)
+			for(y = 0; y < reader.box_height; y++)
+				lcd_mf_set_pixel(dest, reader.box_y + y, mf_read_pixel(&reader));
+	}
+
+	// show changed area, page by page
+	dest = lcd_state.framebuffer + line * lcd_state.width + column;
+	for(y = 0; y < pages; y++, dest += lcd_state.width)
+	{
+		// glyph may reach partial page, which is not a text line
+		lcd_set_address(line + y, column);
+		lcd_write_raw(dest, width);
+	}
+
+	// advance cursor, wrap right after the last column, like 6x8 chars do
+	if(column + width >= lcd_state.width) {
+		lcd_state.current_line = line;
+		lcd_mf_newline(pages);
+	}
+	else
+		lcd_set_cursor(line, column + width);
+	return width;
+}
+
+void lcd_mf_puts(const microfont_t *font, const unsigned char *s)
+{
+	uint32_t c;
+
+	while(*s)
+	{
+		c = lcd_next_char(&s);
+		if(c >= 0x20)
+			lcd_mf_putc(font, c);
+		else if(c == '\n')
+			lcd_mf_newline((font->height + 7) >> 3);
+		else if(c == '\r')
+			lcd_set_cursor(lcd_state.current_line, 0);
+	}
+}
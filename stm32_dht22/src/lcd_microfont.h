@@ -0,0 +1,34 @@
+/*
+ * lcd_microfont.h
+ *
+ *  Text output with fonts made by fontconv (see fontconv/microfont.h).
+ *  Glyphs are drawn to framebuffer, so it works only if display is initialized with one.
+ */
+
+#ifndef LCD_MICROFONT_H_
+#define LCD_MICROFONT_H_
+
+#include "lcd_nokia.h"
+#include "microfont.h"
+
+/*
+ * \brief Print single char at cursor position and advance cursor by glyph width.
+ *        Top of glyph is at top of current text line, font can be several lines high.
+ *        Chars missing in font are printed with font's fallback glyph, if it has one.
+ *        Fonts in page order (fontconv -b pages) are copied straight to framebuffer, that is
+ *        the fastest way, but whole pages of glyph cell are overwritten, even below font height.
+ * \param font microfont block
+ * \param c Unicode codepoint
+ * \return width of printed glyph, 0 if nothing printed
+ */
+int lcd_mf_putc(const microfont_t *font, uint32_t c);
+
+/*
+ * \brief Print string, UTF-8 or Windows-1251, depending on LCD_FLAG_UTF8CYR.
+ *        '\n' moves cursor to the next line of font height, '\r' to line beginning.
+ * \param font microfont block
+ * \param s zero-terminated string buffer
+ */
+void lcd_mf_puts(const microfont_t *font, const unsigned char *s);
+
+#endif /* LCD_MICROFONT_H_ */
@@ -5,28 +5,23 @@
  *      Author: Andrey Perepelitsyn
  */
 
+#include <stdarg.h>
+
 #include "diag/Trace.h"
 #include "lcd_nokia.h"
+// generated: fontconv -f cells -n lcd_chars6x8 -i fonts/lcd6x8.bdf -o src/lcd_chars.h
+// ASCII must stay the first range, at index 0: fast paths below index it directly
 #include "lcd_chars.h"
+#include "lcd_mem.h"
 #include "dht22.h"
+#include "profile.h"
 
-const uint8_t lcd_init_sequence[] = {
-	0xEB, // Thermal comp. on
-	0x2F, // Supply mode
-	0xA1, // Horisontal reverse: Reverse - 0xA9, Normal - 0xA1
-//	0xC9, // Vertical reverse (comment if no need)
-	0xA6, // Positive - A7, Negative - A6
-	0x90, // Contrast 0x90...0x9F
-	0xEC, // Set refresh rate to 80 Hz
-	0xAF, // Enable LCD
-	0xA4  // Display all points normal
-};
+#if LCD_CHARS6X8_PAGES != 1
+#error "charcell text is one display page high"
+#endif
 
 lcd_state_t lcd_state;
 
-GPIO_InitTypeDef lcd_gpio_config;
-SPI_InitTypeDef  lcd_spi_config;
-
 void lcd_dumb_wait(uint32_t msec)
 {
 	uint32_t i, j, k = SystemCoreClock / 11000;
@@ -37,269 +32,429 @@ void lcd_dumb_wait(uint32_t msec)
 	}
 }
 
-uint16_t lcd_init(framebuffer_t *framebuffer, lcd_wait_func_t wait_func)
+static void lcd_setup(const lcd_driver_t *driver, void *framebuffer)
 {
-	uint16_t i;
-
+	// Nokia 1100 is the default one
+	lcd_state.driver = driver == NULL ? &lcd_nokia1100_driver : driver;
+	lcd_state.width = lcd_state.driver->geometry.width;
+	lcd_state.pages = (lcd_state.driver->geometry.height + 7) >> 3;
+	// text uses complete pages only
+	lcd_state.lines = lcd_state.driver->geometry.height >> 3;
 	// use framebuffer
 	lcd_state.framebuffer = framebuffer;
 	// scrolling is on by default, if we have a framebuffer
 	// UTF-8 is on by default, because I use Eclipse
 	lcd_state.flags = framebuffer != NULL ? LCD_FLAG_SCROLL|LCD_FLAG_UTF8CYR : LCD_FLAG_UTF8CYR;
+
+	lcd_state.power = LCD_POWER_ON;
+}
+
+uint16_t lcd_init(const lcd_driver_t *driver, void *framebuffer, lcd_wait_func_t wait_func)
+{
+	uint32_t msec;
+	int step;
+
+	lcd_setup(driver, framebuffer);
 	// use user :) wait function or default one
 	lcd_state.wait_func = wait_func == NULL ? lcd_dumb_wait : wait_func;
 
-	// init clocks
-	RCC_APB2PeriphClockCmd(LCD_SPI_CLK, ENABLE);
-	RCC_AHBPeriphClockCmd(LCD_GPIO_CLK, ENABLE);
-	/*
-	 * init GPIOs.
-	 * since there be no reading, MISO is not used,
-	 * and pin is configured as output GPIO for RESET signal
-	 */
-	// switch SCK and MOSI pins to alternate function
-	GPIO_PinAFConfig(LCD_PORT, LCD_SCK_PIN_NUM, GPIO_AF_0);
-	GPIO_PinAFConfig(LCD_PORT, LCD_MOSI_PIN_NUM, GPIO_AF_0);
-
-	// set common parameters
-	lcd_gpio_config.GPIO_Mode = GPIO_Mode_AF;
-	lcd_gpio_config.GPIO_OType = GPIO_OType_PP;
-	lcd_gpio_config.GPIO_PuPd = GPIO_PuPd_NOPULL;
-	lcd_gpio_config.GPIO_Speed = GPIO_Speed_50MHz;
-
-	// config SCK pin
-	lcd_gpio_config.GPIO_Pin = LCD_SCK_PIN;
-	GPIO_Init(LCD_PORT, &lcd_gpio_config);
-
-	// config MOSI pin
-	lcd_gpio_config.GPIO_Pin = LCD_MOSI_PIN;
-	GPIO_Init(LCD_PORT, &lcd_gpio_config);
-
-	// config MISO pin
-	lcd_gpio_config.GPIO_Mode = GPIO_Mode_OUT;
-	lcd_gpio_config.GPIO_Pin = LCD_RESET_PIN;
-	GPIO_Init(LCD_PORT, &lcd_gpio_config);
-	/*
-	 * init SPI
-	 * hell bunch of configurations :-\
-	 */
-	// just in case
-	SPI_I2S_DeInit(LCD_SPI);
-
-	// config SPI
-	lcd_spi_config.SPI_Direction = SPI_Direction_1Line_Tx;
-	lcd_spi_config.SPI_Mode = SPI_Mode_Master;
-	lcd_spi_config.SPI_DataSize = SPI_DataSize_9b;
-	lcd_spi_config.SPI_CPOL = SPI_CPOL_Low;
-	lcd_spi_config.SPI_CPHA = SPI_CPHA_1Edge;
-//	lcd_spi_config.SPI_CPOL = SPI_CPOL_High;
-//	lcd_spi_config.SPI_CPHA = SPI_CPHA_2Edge;
-	lcd_spi_config.SPI_NSS = SPI_NSS_Soft;
-	lcd_spi_config.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_2;
-	lcd_spi_config.SPI_FirstBit = SPI_FirstBit_MSB;
-	lcd_spi_config.SPI_CRCPolynomial = 7; // ?
-	SPI_Init(LCD_SPI, &lcd_spi_config);
-
-	// enable NSS
-	SPI_NSSInternalSoftwareConfig(LCD_SPI, SPI_NSSInternalSoft_Set);
-
-	// enable SPI
-	SPI_Cmd(LCD_SPI, ENABLE);
-
-	// finally, send RESET signal
-	GPIO_ResetBits(LCD_PORT, LCD_RESET_PIN);
-
-	lcd_state.wait_func(5); // let RESET last 5 msec!
-	GPIO_SetBits(LCD_PORT, LCD_RESET_PIN);
-
-//	// send Reading Mode command
-//	lcd_write_command(0xdb);
-//	// switch SPI to read
-//	SPI_BiDirectionalLineConfig(LCD_SPI, SPI_Direction_Rx);
-//	while(SPI_GetReceptionFIFOStatus(LCD_SPI) < SPI_ReceptionFIFOStatus_HalfFull);
-//	data = SPI_I2S_ReceiveData16(LCD_SPI);
-//	// switch SPI back to write
-//	SPI_BiDirectionalLineConfig(LCD_SPI, SPI_Direction_Tx);
-
-	// send command of internal display reset
-	lcd_write_command(0xE2);
-	// wait...
-	lcd_state.wait_func(20);
-	// send init commands to display
-	for(i = 0; i < sizeof(lcd_init_sequence); i++)
-		lcd_write_command(lcd_init_sequence[i]);
+	for(step = 0; (msec = lcd_state.driver->init(step)) != 0; step++)
+		lcd_state.wait_func(msec);
+	lcd_state.init_step = LCD_INIT_DONE;
 
 	return 0;
 }
 
+void lcd_init_start(const lcd_driver_t *driver, void *framebuffer, uint32_t now)
+{
+	lcd_setup(driver, framebuffer);
+	lcd_state.wait_func = lcd_dumb_wait;
+	lcd_state.init_step = 0;
+	lcd_state.init_until = now;
+	lcd_init_poll(now);
+}
+
+int lcd_init_poll(uint32_t now)
+{
+	uint32_t msec;
+
+	// every step which time has come, there may be no delay between them
+	while(lcd_state.init_step != LCD_INIT_DONE && (int32_t)(now - lcd_state.init_until) >= 0)
+	{
+		if((msec = lcd_state.driver->init(lcd_state.init_step)) == 0)
+			lcd_state.init_step = LCD_INIT_DONE;
+		else {
+			lcd_state.init_step++;
+			lcd_state.init_until = now + msec;
+		}
+	}
+	return lcd_state.init_step == LCD_INIT_DONE;
+}
+
+void lcd_set_address(uint8_t page, uint8_t column)
+{
+	// same condition as in lcd_write_raw(): without framebuffer, sleeping display still gets data
+	if(lcd_state.power != LCD_POWER_SLEEP || lcd_state.framebuffer == NULL)
+		lcd_state.driver->set_address(page, column);
+}
+
 void lcd_set_cursor(uint8_t line, uint8_t column)
 {
-	line &= 7;
-	column &= 127;
-	if(column > 95) column -= 96;
+	// partial page at the bottom is not a text line
+	if(line >= lcd_state.lines) line = 0;
+	if(column >= lcd_state.width) column = 0;
 	lcd_state.current_line = line;
 	lcd_state.current_column = column;
-	lcd_write_command(0xB0 | line);
-	lcd_write_command(0x10 | (column >> 4));
-	lcd_write_command(column & 0x0F);
+	lcd_set_address(line, column);
 }
 
 void lcd_clear(void)
 {
-	int i;
-	uint8_t spaceholder = 0, *p = (uint8_t *)lcd_state.framebuffer;
+	int size = lcd_state.width * lcd_state.pages;
 
 	if(lcd_state.framebuffer != NULL) {
-		for(i = 0; i < sizeof(lcd_state.framebuffer); i++)
-			*p++ = spaceholder;
-		lcd_write_raw(lcd_state.framebuffer, sizeof(lcd_state.framebuffer));
+		lcd_fill32((uint32_t *)lcd_state.framebuffer, 0, size >> 2);
+		lcd_fb_show();
+	}
+	else {
+		// dumb mode: stream zeros to controller
+		lcd_state.driver->set_address(0, 0);
+		lcd_state.driver->fill(0, size);
 	}
-	else
-		for(i = 0; i < sizeof(lcd_state.framebuffer); i++)
-			lcd_write_raw(&spaceholder, 1);
 
 	lcd_set_cursor(0, 0);
 }
 
 void lcd_write_raw(const uint8_t *data, int length)
 {
-	int i;
-	for(i = 0; i < length; i++)
-	{
-		while(SPI_GetTransmissionFIFOStatus(LCD_SPI) >= SPI_TransmissionFIFOStatus_HalfFull);
-		SPI_I2S_SendData16(LCD_SPI, data[i] | 0x100);
-
-	}
+	PROFILE_SCOPE("lcd_write_raw");
+	// sleeping display is updated on wake up from framebuffer
+	if(lcd_state.power == LCD_POWER_SLEEP && lcd_state.framebuffer != NULL)
+		return;
+	lcd_state.driver->write_data(data, length);
 }
 
 void lcd_fb_write_raw(const uint8_t *data, int length)
 {
 	int i;
 	uint8_t *dest;
-	lcd_write_raw(data, length);
 	if(lcd_state.framebuffer != NULL) {
-		dest = &(lcd_state.framebuffer[lcd_state.current_line][lcd_state.current_column]);
+		dest = lcd_state.framebuffer + lcd_state.current_line * lcd_state.width + lcd_state.current_column;
 		for(i = 0; i < length; i++)
-			*dest++ = *data++;
+			dest[i] = data[i];
 	}
+	lcd_write_raw(data, length);
 }
 
 void lcd_write_command(uint8_t command)
 {
-	while(SPI_GetTransmissionFIFOStatus(LCD_SPI) >= SPI_TransmissionFIFOStatus_HalfFull);
-	SPI_I2S_SendData16(LCD_SPI, command);
+	lcd_state.driver->write_command(command);
 }
 
 void lcd_fb_show(void)
 {
-	if(lcd_state.framebuffer != NULL) {
+	if(lcd_state.framebuffer != NULL && lcd_state.power != LCD_POWER_SLEEP) {
 		// set pointer to video-RAM beginning
-		lcd_write_command(0xB0);
-		lcd_write_command(0x10);
-		lcd_write_command(0x00);
+		lcd_state.driver->set_address(0, 0);
 		// write data
-		lcd_write_raw(lcd_state.framebuffer, sizeof(lcd_state.framebuffer));
+		lcd_write_raw(lcd_state.framebuffer, lcd_state.width * lcd_state.pages);
 		lcd_set_cursor(lcd_state.current_line, lcd_state.current_column);
 	}
 }
 
 void lcd_scroll(void)
 {
-	int i, j;
+	PROFILE_SCOPE("lcd_scroll");
+	uint32_t *p = (uint32_t *)lcd_state.framebuffer;
+	int line_words = lcd_state.width >> 2, size = line_words * (lcd_state.lines - 1);
+
 	if(lcd_state.framebuffer != NULL) {
-		for(i = 0; i < 8; i++)
-			for(j = 0; j < 96; j++)
-				lcd_state.framebuffer[i][j] = lcd_state.framebuffer[i+1][j];
+		// move text lines up, clear the last one
+		lcd_move32(p, p + line_words, size);
+		lcd_fill32(p + size, 0, line_words);
 		lcd_fb_show();
 	}
 }
 
+/*
+ * print glyph at cursor position and advance cursor
+ */
+static void lcd_put_glyph(const uint8_t *glyph)
+{
+	lcd_fb_write_raw(glyph, LCD_CHARS6X8_WIDTH);
+	// advance cursor/scroll
+	if((lcd_state.current_column += LCD_CHARS6X8_WIDTH) > lcd_state.width - LCD_CHARS6X8_WIDTH) {
+		// new line
+		lcd_state.current_column = 0;
+		if(++lcd_state.current_line >= lcd_state.lines) {
+			// scroll or wrap, depending if we have a framebuffer and scrolling state
+			if(lcd_state.framebuffer != NULL && (lcd_state.flags & LCD_FLAG_SCROLL)) {
+				lcd_state.current_line = lcd_state.lines - 1;
+				lcd_scroll();
+			}
+			else
+				lcd_state.current_line = 0;
+		}
+		// glyphs may not fill the width, so controller's column is not 0 by itself
+		lcd_set_cursor(lcd_state.current_line, 0);
+	}
+}
+
 void lcd_putc(int c)
 {
+	int glyph;
+
 	// let's process ASCII as fast as possible
 	if(c < 127 && c >= 32) {
-		lcd_fb_write_raw(&(lcd_chars6x8[c - 32][0]), 6);
+		lcd_put_glyph(lcd_chars6x8[c - 32]);
+		return;
 	}
-	else {
-		// cyrillic is a bit slower
-		if(c >= 0xC0 && c <= 0xFF)
-			// cyrillic starts in font array at index 95
-			lcd_fb_write_raw(&(lcd_chars6x8[c - 0xC0 + 95][0]), 6);
-		else
-			// handle control characters
-			switch(c)
-			{
-			case '\n':
-				// new line: new line, then do carriage return
-				if(++lcd_state.current_line >= 8)
-					// scroll or wrap, depending if we have a framebuffer and scrolling state
-					if(lcd_state.framebuffer != NULL && (lcd_state.flags & LCD_FLAG_SCROLL)) {
-						lcd_state.current_line = 7;
-						lcd_scroll();
-					}
-			case '\r':
-				// carriage return: move cursor to beginning of current line
-				lcd_set_cursor(lcd_state.current_line, 0);
-				return;
-			case '\f':
-				// form feed: clear screen
-				lcd_clear();
-				return;
-			default:
-				// non-printable character. skip it
-				return;
-			}
+	if(c >= 127) {
+		// everything else is looked up in range table
+		glyph = charset_find_glyph(lcd_chars6x8_ranges, LCD_CHARS6X8_RANGES, c);
+		lcd_put_glyph(lcd_chars6x8[glyph < 0 ? LCD_CHARS6X8_FALLBACK : glyph]);
+		return;
 	}
-	// advance cursor/scroll
-	if((lcd_state.current_column += 6) >= 96) {
-		// new line
-		lcd_state.current_column = 0;
-		if(++lcd_state.current_line >= 8) {
+	// handle control characters
+	switch(c)
+	{
+	case '\n':
+		// new line: new line, then do carriage return
+		if(++lcd_state.current_line >= lcd_state.lines) {
 			// scroll or wrap, depending if we have a framebuffer and scrolling state
 			if(lcd_state.framebuffer != NULL && (lcd_state.flags & LCD_FLAG_SCROLL)) {
-				lcd_state.current_line = 7;
+				lcd_state.current_line = lcd_state.lines - 1;
 				lcd_scroll();
 			}
 			else
-				lcd_set_cursor(0, 0);
+				lcd_state.current_line = 0;
 		}
+	case '\r':
+		// carriage return: move cursor to beginning of current line
+		lcd_set_cursor(lcd_state.current_line, 0);
+		return;
+	case '\f':
+		// form feed: clear screen
+		lcd_clear();
+		return;
+	default:
+		// non-printable character. skip it
+		return;
 	}
 }
 
+uint32_t lcd_next_char(const unsigned char **s)
+{
+	uint32_t c = **s;
+
+	if(c < 0x80)
+		(*s)++;
+	else if(lcd_state.flags & LCD_FLAG_UTF8CYR)
+		c = charset_utf8_decode(s);
+	else
+		c = charset_cp1251_decode(*(*s)++);
+	return c;
+}
+
+/*
+ * nonzero if any of 4 bytes in word is not a printable ASCII char (0x20..0x7E).
+ * borrows and carries between bytes happen only next to a bad byte, which is caught anyway.
+ */
+#define LCD_WORD_NOT_PRINTABLE(w) ((((w) - 0x20202020UL) | (w) | ((w) + 0x01010101UL)) & 0x80808080UL)
+
+/*
+ * nonzero if any of 4 bytes in word is zero
+ */
+#define LCD_WORD_HAS_ZERO(w) (((w) - 0x01010101UL) & ~(w) & 0x80808080UL)
+
+typedef uint32_t __attribute__((may_alias)) lcd_text_word_t;
+
+/*
+ * print text up to terminating zero or stop char
+ * \return pointer to zero or stop char
+ */
+static const unsigned char *lcd_put_text(const unsigned char *s, unsigned char stop)
+{
+	uint32_t c, stop_mask = stop * 0x01010101UL;
+
+	while(*s && *s != stop)
+	{
+		// ASCII fast path: whole aligned words of printable chars go straight to glyph table.
+		// string is never read past the word holding its terminating zero
+		if(((uintptr_t)s & 3) == 0) {
+			uint32_t w;
+			while(w = *(const lcd_text_word_t *)s,
+					!(LCD_WORD_NOT_PRINTABLE(w) | LCD_WORD_HAS_ZERO(w ^ stop_mask)))
+			{
+				lcd_put_glyph(lcd_chars6x8[(w & 0xFF) - 32]);
+				lcd_put_glyph(lcd_chars6x8[((w >> 8) & 0xFF) - 32]);
+				lcd_put_glyph(lcd_chars6x8[((w >> 16) & 0xFF) - 32]);
+				lcd_put_glyph(lcd_chars6x8[(w >> 24) - 32]);
+				s += 4;
+			}
+			if(!*s || *s == stop)
+				break;
+		}
+		c = *s;
+		if(c < 0x80)
+			s++;
+		else
+			c = lcd_next_char(&s);
+		lcd_putc(c);
+	}
+	return s;
+}
+
 void lcd_puts(const unsigned char *s)
 {
-	if(lcd_state.flags & LCD_FLAG_UTF8CYR) {
-		// interprete UTF-8 cyrillic chars
-		while(*s)
+	PROFILE_SCOPE("lcd_puts");
+	lcd_put_text(s, 0);
+}
+
+#define LCD_PRINTF_LEFT 1 // '-' flag
+#define LCD_PRINTF_ZERO 2 // '0' flag
+
+/*
+ * division by 10 with shifts and adds, Cortex-M0 has no divide instruction
+ */
+static inline uint32_t lcd_div10(uint32_t n)
+{
+	uint32_t q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q >>= 3;
+	// q is exact or one less
+	return q + (n - q * 10 > 9);
+}
+
+static void lcd_put_padding(int c, int count)
+{
+	while(count-- > 0)
+		lcd_put_glyph(lcd_chars6x8[c - 32]);
+}
+
+/*
+ * print number with optional sign, padding and fixed point
+ * \param prec digits after decimal point, 0 for integer
+ */
+static void lcd_put_number(uint32_t n, int negative, int hex, int width, int prec, int flags)
+{
+	static const char digits[] = "0123456789abcdef";
+	char buf[12];
+	int len = 0, i;
+
+	// least significant digit first; at least one digit before decimal point
+	do {
+		if(hex) {
+			buf[len++] = digits[n & 15];
+			n >>= 4;
+		}
+		else {
+			uint32_t q = lcd_div10(n);
+			buf[len++] = digits[n - q * 10];
+			n = q;
+		}
+	} while(n || len <= prec);
+
+	width -= len + negative + (prec != 0);
+	if(!(flags & (LCD_PRINTF_LEFT | LCD_PRINTF_ZERO)))
+		lcd_put_padding(' ', width);
+	if(negative)
+		lcd_put_glyph(lcd_chars6x8['-' - 32]);
+	if(flags & LCD_PRINTF_ZERO)
+		lcd_put_padding('0', width);
+	for(i = len - 1; i >= 0; i--)
+	{
+		lcd_put_glyph(lcd_chars6x8[buf[i] - 32]);
+		if(i == prec && prec)
+			lcd_put_glyph(lcd_chars6x8['.' - 32]);
+	}
+	if(flags & LCD_PRINTF_LEFT)
+		lcd_put_padding(' ', width);
+}
+
+void lcd_printf(const char *format, ...)
+{
+	PROFILE_SCOPE("lcd_printf");
+	const unsigned char *f = (const unsigned char *)format;
+	va_list ap;
+
+	va_start(ap, format);
+	while(*(f = lcd_put_text(f, '%')))
+	{
+		int flags = 0, width = 0, prec = 0;
+		const unsigned char *s;
+		int32_t n;
+
+		// flags
+		for(f++; ; f++)
+			if(*f == '-')
+				flags |= LCD_PRINTF_LEFT;
+			else if(*f == '0')
+				flags |= LCD_PRINTF_ZERO;
+			else
+				break;
+		if(flags & LCD_PRINTF_LEFT)
+			flags &= ~LCD_PRINTF_ZERO;
+		// width and fixed point precision
+		while(*f >= '0' && *f <= '9')
+			width = width * 10 + *f++ - '0';
+		if(*f == '.')
+			while(*++f >= '0' && *f <= '9')
+				prec = prec * 10 + *f - '0';
+		// int and long are the same here
+		if(*f == 'l')
+			f++;
+
+		switch(*f)
 		{
-			if(*s == 0xD0) {
-				// А..Я,а..п: UD090..UD0BF
-				s++;
-				if(!*s) // unexpected end
-					return;
-				if(*s >= 0x90 && *s < 0xC0)
-					lcd_putc(*s + (0xC0 - 0x90)); // 'A' in Win1251 -- 0xC0
-				s++;
-				continue;
+		case 'd':
+		case 'i':
+			n = va_arg(ap, int32_t);
+			lcd_put_number(n < 0 ? -(uint32_t)n : (uint32_t)n, n < 0, 0, width, prec, flags);
+			break;
+		case 'u':
+			lcd_put_number(va_arg(ap, uint32_t), 0, 0, width, prec, flags);
+			break;
+		case 'x':
+		case 'X':
+			lcd_put_number(va_arg(ap, uint32_t), 0, 1, width, 0, flags);
+			break;
+		case 'c':
+			lcd_put_padding(' ', (flags & LCD_PRINTF_LEFT) ? 0 : width - 1);
+			lcd_putc(va_arg(ap, int));
+			lcd_put_padding(' ', (flags & LCD_PRINTF_LEFT) ? width - 1 : 0);
+			break;
+		case 's':
+			s = va_arg(ap, const unsigned char *);
+			if(width) {
+				// count chars, not bytes: skip UTF-8 continuation bytes
+				const unsigned char *p;
+				for(p = s; *p; p++)
+					if(!(lcd_state.flags & LCD_FLAG_UTF8CYR) || (*p & 0xC0) != 0x80)
+						width--;
 			}
-			if(*s == 0xD1) {
-				// р..я:      UD180..UD18F
-				s++;
-				if(!*s) // unexpected end
-					return;
-				if(*s >= 0x80 && *s < 0x90)
-					lcd_putc(*s + (0xF0 - 0x80)); // 'р' in Win1251 -- 0xF0
-				s++;
-				continue;
-			}
-			// ascii char
-			lcd_putc(*s++);
+			if(!(flags & LCD_PRINTF_LEFT))
+				lcd_put_padding(' ', width);
+			lcd_put_text(s, 0);
+			if(flags & LCD_PRINTF_LEFT)
+				lcd_put_padding(' ', width);
+			break;
+		case '%':
+			lcd_put_glyph(lcd_chars6x8['%' - 32]);
+			break;
+		case 0:
+			// format ends after '%'
+			va_end(ap);
+			return;
+		default:
+			// unknown conversion, skip it
+			break;
 		}
+		f++;
 	}
-	else
-		// 1-byte encoding handling is trivial
-		while(*s)
-			lcd_putc(*s++);
+	va_end(ap);
 }
 
 void lcd_set_flags(uint16_t flags)
@@ -307,4 +462,24 @@ void lcd_set_flags(uint16_t flags)
 	lcd_state.flags = flags;
 }
 
+void lcd_set_power(lcd_power_t mode)
+{
+	lcd_power_t old_mode = lcd_state.power;
+
+	if(mode == old_mode)
+		return;
+	lcd_state.power = mode;
+	// wake up: framebuffer contents and controller RAM may differ, single flush fixes it
+	if(old_mode == LCD_POWER_SLEEP)
+		lcd_fb_show();
+	lcd_state.driver->set_power(mode);
+}
+
+int lcd_set_partial(uint8_t first_page, uint8_t pages)
+{
+	if(lcd_state.driver->set_partial == NULL)
+		return -1;
+	return lcd_state.driver->set_partial(first_page, pages);
+}
+
 
@@ -5,87 +5,83 @@
  *      Author: Andrey Perepelitsyn
  *
  *  Lib for using monochrome Nokia cellphone LCD display
- *  tested on 1110i, but 1110 and 1202 should work without code changes
+ *  tested on 1110i, but 1110 and 1202 should work without code changes.
+ *  Other page-organized panels (PCD8544, SSD1306) are supported by drivers, see lcd_driver.h
  *
  *  Features:
- *  fast hardware 9-bit SPI, terminal output with scrolling, 6x8 charcell,
- *  Windows-1251 or UTF-8 encoding for cyrillic chars,
- *  framebuffer for pixel graphics implementation
+ *  fast hardware SPI, DMA where controller allows it, terminal output with scrolling, 6x8 charcell,
+ *  Windows-1251 or UTF-8 encoding, table-driven mapping of Unicode chars to glyphs,
+ *  framebuffer for pixel graphics implementation,
+ *  big and proportional fonts made by fontconv, see lcd_microfont.h
+ *
+ *  power management: sleep, blanking, partial display
  *
  *  TODO:
- *  enhanced display support -- power management, orientation, contrast, etc
- *  big fonts, proportional fonts, graphics primitives?
+ *  enhanced display support -- orientation, contrast, etc
+ *  graphics primitives?
  */
 
 #ifndef LCD_NOKIA_H_
 #define LCD_NOKIA_H_
 
-#include <stm32f0xx_conf.h>
-/*
- * choose from SPI1 and SPI2 ports
- */
-#undef  LCD_USE_SPI2
-//#define LCD_USE_SPI2
-
-#ifdef USE_SPI2
-
-#define LCD_PORT           GPIOB
-#define LCD_SCK_PIN_NUM    ((uint8_t)13)
-#define LCD_RESET_PIN_NUM  ((uint8_t)14)
-#define LCD_MOSI_PIN_NUM   ((uint8_t)15)
-#define LCD_SPI            SPI2
-#define LCD_SPI_CLK        RCC_APB1Periph_SPI2
-#define LCD_GPIO_CLK       RCC_AHBPeriph_GPIOB
-#define LCD_SPI_IRQn       SPI2_IRQn
-#define LCD_SPI_IRQHandler SPI2_IRQHandler
-
-#else
-
-#define LCD_PORT           GPIOA
-#define LCD_SCK_PIN_NUM    ((uint8_t)5)
-#define LCD_RESET_PIN_NUM  ((uint8_t)6)
-#define LCD_MOSI_PIN_NUM   ((uint8_t)7)
-#define LCD_SPI            SPI1
-#define LCD_SPI_CLK        RCC_APB2Periph_SPI1
-#define LCD_GPIO_CLK       RCC_AHBPeriph_GPIOA
-#define LCD_SPI_IRQn       SPI1_IRQn
-#define LCD_SPI_IRQHandler SPI1_IRQHandler
-
-#define LCD_SCK_PIN        ((uint16_t)(1 << LCD_SCK_PIN_NUM))
-#define LCD_RESET_PIN      ((uint16_t)(1 << LCD_RESET_PIN_NUM))
-#define LCD_MOSI_PIN       ((uint16_t)(1 << LCD_MOSI_PIN_NUM))
-
-#endif // USE_SPI2
+#include "lcd_driver.h"
 
 #define LCD_FLAG_SCROLL    1       // scrolling is on
-#define LCD_FLAG_UTF8CYR   2       // use UTF-8 for cyrillic strings, not Windows-1251
+#define LCD_FLAG_UTF8CYR   2       // strings are UTF-8, not Windows-1251
 
-typedef void (*lcd_wait_func_t)(uint32_t);
+#define LCD_INIT_DONE      0xFF    // init_step when display is ready
 
 /*
- * \brief Nokia 1100, 1110, 1110i, 1202... LCD framebuffer presentation
+ * framebuffer is array of pages, each page is geometry.width bytes long
  */
-typedef uint8_t lcd_framebuffer_t[9][96];
-
 typedef struct {
-	lcd_framebuffer_t *framebuffer;
-	lcd_wait_func_t    wait_func;
-	uint16_t           flags;          // scrolling, encoding, etc
-	uint8_t            current_line;   // text line, [0..7] (8th is not used)
-	uint8_t            current_column; // graphics column, not text! [0..95]
+	const lcd_driver_t *driver;
+	uint8_t            *framebuffer;
+	lcd_wait_func_t     wait_func;
+	uint16_t            flags;          // scrolling, encoding, etc
+	uint8_t             width;          // from driver geometry, in pixels
+	uint8_t             pages;          // 8-pixel rows, including incomplete one
+	uint8_t             lines;          // text lines, complete pages only
+	uint8_t             power;          // lcd_power_t mode
+	uint8_t             current_line;   // text line, [0..lines-1]
+	uint8_t             current_column; // graphics column, not text! [0..width-1]
+	uint8_t             init_step;      // next driver init step, LCD_INIT_DONE if ready
+	uint32_t            init_until;     // time of next init step, by caller's clock in msec
 } lcd_state_t;
 
+/*
+ * display state, shared with renderers living outside of lcd_nokia.c
+ */
+extern lcd_state_t lcd_state;
+
 /*
  * \brief Initialize display
  * \return 0 if successful. At the time, there is no checks for success, so 0 returned always.
  *         TODO: Maybe sometime read mode will be implemented to obtain init status.
- * \param framebuffer pointer to 96*9 bytes memory area to store framebuffer.
+ * \param driver display controller backend, see lcd_driver.h. If NULL, Nokia 1100 is used.
+ * \param framebuffer pointer to LCD_FRAMEBUFFER_SIZE(&driver->geometry) bytes memory area
+ *        to store framebuffer, word aligned. 96*9 bytes for Nokia 1100.
  *        Using FB makes possible pixel operations, scrolling, etc.
  *        If NULL, LCD library will be started in dumb mode.
  * \param delay_func function to do delays in init process, takes number of milliseconds
  *        as an argument. If NULL, dumb loop delay will be used.
  */
-uint16_t lcd_init(framebuffer_t *framebuffer, lcd_wait_func_t wait_func);
+uint16_t lcd_init(const lcd_driver_t *driver, void *framebuffer, lcd_wait_func_t wait_func);
+
+/*
+ * \brief Start display init without waiting, parameters are the same as of lcd_init().
+ *        Reset and init sequence are then driven by lcd_init_poll(), display must not be
+ *        used until it returns nonzero. 30 ms of Nokia 1100 init go to other boot work.
+ * \param now time in milliseconds, by any timebase (boot_ms(), SysTick counter...)
+ */
+void lcd_init_start(const lcd_driver_t *driver, void *framebuffer, uint32_t now);
+
+/*
+ * \brief Do init steps which time has come
+ * \param now time in milliseconds, by the same timebase as for lcd_init_start()
+ * \return nonzero if display is ready
+ */
+int lcd_init_poll(uint32_t now);
 
 /*
  * dumb loop wait function, used in display init, if no user wait function provided
@@ -101,18 +97,26 @@ void lcd_fb_show(void);
 /*
  * \brief Set text position, where next character will be printed.
  *        Note, that horizontal position is set in pixels, not in characters!
- * \param line [0..7]
- * \param column [0..95]
+ * \param line [0..lines-1], 0..7 for Nokia 1100
+ * \param column [0..width-1], 0..95 for Nokia 1100
  */
 void lcd_set_cursor(uint8_t line, uint8_t column);
 
+/*
+ * \brief Set display address for lcd_write_raw(), text cursor doesn't move
+ * \param page [0..pages-1], including partial page at the bottom, 0..8 for Nokia 1100
+ * \param column [0..width-1]
+ */
+void lcd_set_address(uint8_t page, uint8_t column);
+
 /*
  * \brief Clear display
  */
 void lcd_clear(void);
 
 /*
- * \brief Write raw data to display. Data is sent byte by byte, with bit 8 set to 1 (data)
+ * \brief Write raw data to display at current address. Driver may send it by DMA,
+ *        so data must not change until next display call.
  * \param data source buffer
  * \length size of data buffer
  */
@@ -138,19 +142,35 @@ void lcd_scroll(void);
 
 /*
  * \brief Print single char and advance cursor.
- *        Windows-1251 cyrillic letters are supported.
  *        Scroll display after printing to bottom right most position.
- *        Cyrillic UTF-8 chars are supported.
- * \param c ascii code
+ *        Chars missing in font are printed as '?'.
+ * \param c Unicode codepoint
  */
 void lcd_putc(int c);
 
 /*
- * \brief Print string of chars. UTF-8 cyrillic letters are supported.
+ * \brief Decode char of string, UTF-8 or Windows-1251, depending on LCD_FLAG_UTF8CYR
+ * \param s pointer to string pointer, advanced past the char; must not point at zero byte
+ * \return Unicode codepoint
+ */
+uint32_t lcd_next_char(const unsigned char **s);
+
+/*
+ * \brief Print string of chars, UTF-8 or Windows-1251, depending on LCD_FLAG_UTF8CYR.
+ *        Runs of printable ASCII chars are processed a word at a time.
  * \param s zero-terminated string buffer
  */
 void lcd_puts(const unsigned char *s);
 
+/*
+ * \brief Formatted output straight to display, no intermediate buffer.
+ *        Integer-only subset of printf: %d, %i, %u, %x, %s, %c, %%,
+ *        flags '-' and '0', field width, 'l' modifier is accepted and ignored.
+ *        Precision of %d/%u prints fixed point number: ("%.1d", 253) gives "25.3".
+ * \param format format string, same encoding as lcd_puts()
+ */
+void lcd_printf(const char *format, ...);
+
 /*
  * \brief Set flags: strings encoding, screen scrolling, etc
  * \param flags See lcd_state_t definition for details.
@@ -158,6 +178,23 @@ void lcd_puts(const unsigned char *s);
  */
 void lcd_set_flags(uint16_t flags);
 
+/*
+ * \brief Switch display power mode.
+ *        In LCD_POWER_SLEEP mode with framebuffer, output goes to framebuffer only,
+ *        and it is flushed to display once on wake up, so nothing needs to be redrawn.
+ * \param mode see lcd_power_t
+ */
+void lcd_set_power(lcd_power_t mode);
+
+/*
+ * \brief Drive only given pages of display, to save power when showing a few lines.
+ * \param first_page first page (text line) shown
+ * \param pages number of pages shown, 0 for whole display
+ * \return 0 if successful, -1 if controller has no partial display mode or can't show
+ *         this range (past the last page, fewer than 2 pages for SSD1306): nothing is changed
+ */
+int lcd_set_partial(uint8_t first_page, uint8_t pages);
+
 #endif /* LCD_NOKIA_H_ */
 
 
@@ -0,0 +1,131 @@
+/*
+ * lcd_spi.c
+ */
+
+#include "lcd_spi.h"
+
+GPIO_InitTypeDef lcd_gpio_config;
+SPI_InitTypeDef  lcd_spi_config;
+
+void lcd_spi_init(uint16_t data_size)
+{
+	// init clocks
+	LCD_SPI_CLK_CMD(LCD_SPI_CLK, ENABLE);
+	RCC_AHBPeriphClockCmd(LCD_GPIO_CLK, ENABLE);
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+	/*
+	 * init GPIOs.
+	 * since there be no reading, MISO is not used,
+	 * and pin is configured as output GPIO for RESET signal
+	 */
+	// switch SCK and MOSI pins to alternate function
+	GPIO_PinAFConfig(LCD_PORT, LCD_SCK_PIN_NUM, GPIO_AF_0);
+	GPIO_PinAFConfig(LCD_PORT, LCD_MOSI_PIN_NUM, GPIO_AF_0);
+
+	// set common parameters
+	lcd_gpio_config.GPIO_Mode = GPIO_Mode_AF;
+	lcd_gpio_config.GPIO_OType = GPIO_OType_PP;
+	lcd_gpio_config.GPIO_PuPd = GPIO_PuPd_NOPULL;
+	lcd_gpio_config.GPIO_Speed = GPIO_Speed_50MHz;
+
+	// config SCK and MOSI pins
+	lcd_gpio_config.GPIO_Pin = LCD_SCK_PIN | LCD_MOSI_PIN;
+	GPIO_Init(LCD_PORT, &lcd_gpio_config);
+
+	// config RESET (former MISO) and D/C (former NSS) pins
+	lcd_gpio_config.GPIO_Mode = GPIO_Mode_OUT;
+	lcd_gpio_config.GPIO_Pin = LCD_RESET_PIN | LCD_DC_PIN;
+	GPIO_Init(LCD_PORT, &lcd_gpio_config);
+	/*
+	 * init SPI
+	 * hell bunch of configurations :-\
+	 */
+	// just in case
+	SPI_I2S_DeInit(LCD_SPI);
+
+	// config SPI
+	lcd_spi_config.SPI_Direction = SPI_Direction_1Line_Tx;
+	lcd_spi_config.SPI_Mode = SPI_Mode_Master;
+	lcd_spi_config.SPI_DataSize = data_size;
+	lcd_spi_config.SPI_CPOL = SPI_CPOL_Low;
+	lcd_spi_config.SPI_CPHA = SPI_CPHA_1Edge;
+	lcd_spi_config.SPI_NSS = SPI_NSS_Soft;
+	lcd_spi_config.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_2;
+	lcd_spi_config.SPI_FirstBit = SPI_FirstBit_MSB;
+	lcd_spi_config.SPI_CRCPolynomial = 7; // ?
+	SPI_Init(LCD_SPI, &lcd_spi_config);
+
+	// enable NSS
+	SPI_NSSInternalSoftwareConfig(LCD_SPI, SPI_NSSInternalSoft_Set);
+
+	// let DMA feed transmit FIFO
+	LCD_SPI->CR2 |= SPI_CR2_TXDMAEN;
+
+	// enable SPI
+	SPI_Cmd(LCD_SPI, ENABLE);
+
+	// finally, start RESET signal, it must last LCD_SPI_RESET_MS
+	GPIO_ResetBits(LCD_PORT, LCD_RESET_PIN);
+}
+
+/*
+ * previous DMA transfer must be finished before FIFO or DMA is used again
+ */
+static inline void lcd_spi_dma_done(void)
+{
+	if(LCD_DMA_CHANNEL->CCR & DMA_CCR_EN) {
+		while(LCD_DMA_CHANNEL->CNDTR);
+		LCD_DMA_CHANNEL->CCR = 0;
+	}
+}
+
+void lcd_spi_wait(void)
+{
+	// DMA channel first, then FIFO and shift register
+	lcd_spi_dma_done();
+	while(LCD_SPI->SR & SPI_SR_FTLVL);
+	while(LCD_SPI->SR & SPI_SR_BSY);
+}
+
+void lcd_spi_set_dc(int data)
+{
+	lcd_spi_wait();
+	if(data)
+		LCD_PORT->BSRR = LCD_DC_PIN;
+	else
+		LCD_PORT->BRR = LCD_DC_PIN;
+}
+
+RAMFUNC void lcd_spi_write(const uint8_t *data, int length)
+{
+	lcd_spi_dma_done();
+	if(length < LCD_SPI_DMA_THRESHOLD) {
+		while(length--)
+			lcd_spi_send(*data++);
+		return;
+	}
+	// 8-bit memory and peripheral size, memory to peripheral
+	LCD_DMA_CHANNEL->CPAR = (uint32_t)&LCD_SPI->DR;
+	LCD_DMA_CHANNEL->CMAR = (uint32_t)data;
+	LCD_DMA_CHANNEL->CNDTR = length;
+	LCD_DMA_CHANNEL->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN;
+}
+
+void lcd_spi_fill(uint8_t value, int length)
+{
+	// DMA source, must live until transfer ends
+	static uint8_t fill_value;
+
+	lcd_spi_dma_done();
+	if(length < LCD_SPI_DMA_THRESHOLD) {
+		while(length--)
+			lcd_spi_send(value);
+		return;
+	}
+	fill_value = value;
+	// same as lcd_spi_write(), but memory address is not incremented
+	LCD_DMA_CHANNEL->CPAR = (uint32_t)&LCD_SPI->DR;
+	LCD_DMA_CHANNEL->CMAR = (uint32_t)&fill_value;
+	LCD_DMA_CHANNEL->CNDTR = length;
+	LCD_DMA_CHANNEL->CCR = DMA_CCR_DIR | DMA_CCR_EN;
+}
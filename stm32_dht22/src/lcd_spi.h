@@ -0,0 +1,121 @@
+/*
+ * lcd_spi.h
+ *
+ *  SPI port shared by all display drivers: pins, 8/9-bit transfers, DMA for bulk data.
+ *  Not for direct use by application, see lcd_driver.h
+ */
+
+#ifndef LCD_SPI_H_
+#define LCD_SPI_H_
+
+#include <stm32f0xx_conf.h>
+#include "ramfunc.h"
+
+/*
+ * choose from SPI1 and SPI2 ports
+ */
+#undef  LCD_USE_SPI2
+//#define LCD_USE_SPI2
+
+/*
+ * pin numbers are plain, so other modules can check for conflicts by preprocessor
+ */
+#ifdef LCD_USE_SPI2
+
+#define LCD_PORT           GPIOB
+#define LCD_PORT_INDEX     1   // 0 is GPIOA, 1 is GPIOB...
+#define LCD_DC_PIN_NUM     12
+#define LCD_SCK_PIN_NUM    13
+#define LCD_RESET_PIN_NUM  14
+#define LCD_MOSI_PIN_NUM   15
+#define LCD_SPI            SPI2
+#define LCD_SPI_CLK        RCC_APB1Periph_SPI2
+#define LCD_SPI_CLK_CMD    RCC_APB1PeriphClockCmd
+#define LCD_GPIO_CLK       RCC_AHBPeriph_GPIOB
+#define LCD_SPI_IRQn       SPI2_IRQn
+#define LCD_SPI_IRQHandler SPI2_IRQHandler
+#define LCD_DMA_CHANNEL    DMA1_Channel5
+
+#else
+
+#define LCD_PORT           GPIOA
+#define LCD_PORT_INDEX     0
+#define LCD_DC_PIN_NUM     4
+#define LCD_SCK_PIN_NUM    5
+#define LCD_RESET_PIN_NUM  6
+#define LCD_MOSI_PIN_NUM   7
+#define LCD_SPI            SPI1
+#define LCD_SPI_CLK        RCC_APB2Periph_SPI1
+#define LCD_SPI_CLK_CMD    RCC_APB2PeriphClockCmd
+#define LCD_GPIO_CLK       RCC_AHBPeriph_GPIOA
+#define LCD_SPI_IRQn       SPI1_IRQn
+#define LCD_SPI_IRQHandler SPI1_IRQHandler
+#define LCD_DMA_CHANNEL    DMA1_Channel3
+
+#endif // LCD_USE_SPI2
+
+#define LCD_SCK_PIN        ((uint16_t)(1 << LCD_SCK_PIN_NUM))
+#define LCD_RESET_PIN      ((uint16_t)(1 << LCD_RESET_PIN_NUM))
+#define LCD_MOSI_PIN       ((uint16_t)(1 << LCD_MOSI_PIN_NUM))
+#define LCD_DC_PIN         ((uint16_t)(1 << LCD_DC_PIN_NUM))   // data/command select, 4-wire panels only
+
+/*
+ * transfers shorter than this are pushed through FIFO, DMA setup is not worth it
+ */
+#define LCD_SPI_DMA_THRESHOLD 16
+
+typedef void (*lcd_wait_func_t)(uint32_t);
+
+#define LCD_SPI_RESET_MS 5 // how long display RESET line is held low
+
+/*
+ * \brief Configure GPIOs, SPI and DMA clock, then pull display RESET line low.
+ *        Release it by lcd_spi_reset_done() after LCD_SPI_RESET_MS.
+ * \param data_size SPI_DataSize_8b or SPI_DataSize_9b
+ */
+void lcd_spi_init(uint16_t data_size);
+
+/*
+ * \brief End of display RESET pulse
+ */
+static inline void lcd_spi_reset_done(void)
+{
+	LCD_PORT->BSRR = LCD_RESET_PIN;
+}
+
+/*
+ * \brief Wait until all queued data (DMA and FIFO) is shifted out
+ */
+void lcd_spi_wait(void);
+
+/*
+ * \brief Push one frame (8 or 9 bits) to SPI FIFO
+ */
+static inline void lcd_spi_send(uint16_t frame)
+{
+	while((LCD_SPI->SR & SPI_SR_FTLVL) >= SPI_TransmissionFIFOStatus_HalfFull);
+	if(LCD_SPI->CR2 & SPI_CR2_DS_3)
+		LCD_SPI->DR = frame;
+	else
+		// 8-bit access, or two frames will be sent
+		*(__IO uint8_t *)&LCD_SPI->DR = (uint8_t)frame;
+}
+
+/*
+ * \brief Switch D/C line of 4-wire panels, waits for pending data first
+ * \param data nonzero for data, zero for commands
+ */
+void lcd_spi_set_dc(int data);
+
+/*
+ * \brief Send buffer of 8-bit frames. Long buffers are sent by DMA in background,
+ *        so data must not change until the next lcd_spi_* call.
+ */
+RAMFUNC void lcd_spi_write(const uint8_t *data, int length);
+
+/*
+ * \brief Send the same 8-bit frame length times, by DMA from constant source
+ */
+void lcd_spi_fill(uint8_t value, int length);
+
+#endif /* LCD_SPI_H_ */
@@ -0,0 +1,46 @@
+/*
+ * log.h
+ *
+ *  Binary logging with formatting deferred to host. LOG() stores format string in .logstr
+ *  section, which is kept in ELF but not loaded to flash, and writes to trace channel only
+ *  the string address and raw argument words. logdecode (top level of repository) reads
+ *  strings from ELF and prints the text:
+ *  	logdecode stm32_dht22.elf < capture.bin
+ *
+ *  Record: byte 0xFF (never found in UTF-8 text, so records and trace_printf() text may be
+ *  mixed in one stream), 4 bits of argument count, 20 bits of string address, then arguments,
+ *  32-bit little-endian words. 4 bytes for call without arguments, 4 more per argument.
+ *
+ *  Arguments are integers: %d %i %u %x %X %o %c, with flags, width and 'l' modifier.
+ *  No %s, the string doesn't go to the stream; pointers must be cast to integer for %p.
+ *  Up to 8 arguments.
+ *
+ *  Records go through trace_write(), so TRACE must be defined. With OS_USE_TRACE_RINGBUF
+ *  LOG() takes a few dozen cycles and doesn't stop the core, so it may be left in production.
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+#include "diag/Trace.h"
+
+#define LOG_MARKER 0xFF
+
+/*
+ * number of macro arguments, 0..8
+ */
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+/*
+ * \brief Log message, formatted later by host. Format must be string literal.
+ */
+#define LOG(format, ...) do { \
+		static const char log_format[] __attribute__((section(".logstr"), used)) = format; \
+		const uint32_t log_record[] = { \
+			LOG_MARKER | (LOG_NARGS(__VA_ARGS__) << 8) | ((uint32_t)(uintptr_t)log_format << 12), ##__VA_ARGS__ }; \
+		trace_write((const char *)log_record, sizeof(log_record)); \
+	} while(0)
+
+#endif /* LOG_H_ */
@@ -5,17 +5,32 @@
 #include "diag/Trace.h"
 #include <cmsis_device.h>
 #include <stm32f0xx_conf.h>
-#include <stdio.h>
 
 #include "dht22.h"
 #include "lcd_nokia.h"
+#include "log.h"
+#include "profile.h"
+#include "pcsample.h"
+#include "irqlat.h"
+#include "ramstat.h"
+#include "mempool.h"
+#include "boot.h"
+#include "clock.h"
 
 static void metering_done(dht22_t *data)
 {
+	static int first = 1;
+
+	// boot ends with the first reading, later ones would only overwrite its mark
+	if(first) {
+		boot_mark("sensor");
+		boot_print();
+		first = 0;
+	}
 	if(data->result == DHT22_OK)
-		trace_printf("temperature: %d, humidity: %d\n", data->temperature, data->humidity);
+		LOG("temperature: %d, humidity: %d\n", data->temperature, data->humidity);
 	else
-		trace_printf("got error %d\n", data->result);
+		LOG("got error %d\n", data->result);
 }
 
 static void my_wait(uint32_t msec)
@@ -27,18 +42,25 @@ void main(void)
 {
 	dht22_t dht22;
 	RCC_ClocksTypeDef rcc_clocks;
-	int i;
+	int i, first = 1;
 
 	uint32_t fb[96*9/4];
-	unsigned char buf[200];
 
-	lcd_init(fb, NULL);
+	boot_mark("main");
+	// display reset runs while the rest is set up
+	lcd_init_start(&lcd_nokia1100_driver, fb, boot_ms());
+	profile_init();
+	pcsample_init();
+	RCC_GetClocksFreq(&rcc_clocks);
+	boot_mark("setup");
+	while(!lcd_init_poll(boot_ms()))
+		;
+	boot_mark("lcd");
 	lcd_clear();
 	lcd_set_flags(LCD_FLAG_SCROLL);
-	RCC_GetClocksFreq(&rcc_clocks);
 	SysTick_Config(10000000L);
 	lcd_fb_show();
-	sprintf(buf,
+	lcd_printf(
 			"SYS:   %8lu\n"
 			"AHB:   %8lu\n"
 			"APB:   %8lu\n"
@@ -50,7 +72,10 @@ void main(void)
 			rcc_clocks.SYSCLK_Frequency, rcc_clocks.HCLK_Frequency, rcc_clocks.PCLK_Frequency, rcc_clocks.ADCCLK_Frequency,
 			rcc_clocks.CECCLK_Frequency, rcc_clocks.I2C1CLK_Frequency, rcc_clocks.USART1CLK_Frequency,
 			10000000UL - SysTick->VAL);
-	lcd_puts(buf);
+
+#ifdef IRQLAT
+	irqlat_loop();
+#endif
 
 #ifdef DHT22_ASYNC
 
@@ -67,15 +92,26 @@ void main(void)
 	{
 		SysTick_Config(10000000);
 		lcd_dumb_wait(10);
-		sprintf(buf, "\n%lu", 10000000 - SysTick->VAL);
-		lcd_puts(buf);
+		lcd_printf("\n%lu", 10000000 - SysTick->VAL);
+		// idle at 8 MHz, read and draw at full speed
+		clock_set(CLOCK_HSI8);
 		for(i = 0; i < 3000; i++)
 			dht22_wait(SystemCoreClock / 1000);
+		if(clock_set(CLOCK_PLL48) != 0)
+			trace_printf("clock: staying at %u Hz\n", (unsigned)SystemCoreClock);
 		if(dht22_dumb_read_sensor(&dht22) == DHT22_OK)
-			sprintf(buf, "\nt:%d.%d, h:%d.%d", dht22.temperature / 10, dht22.temperature % 10, dht22.humidity / 10, dht22.humidity % 10);
+			lcd_printf("\nt:%.1d, h:%.1u", dht22.temperature, dht22.humidity);
 		else
-			sprintf(buf, "\ngot error %d", dht22.result);
-		lcd_puts(buf);
+			lcd_printf("\ngot error %d", dht22.result);
+		if(first) {
+			boot_mark("sensor");
+			boot_print();
+			first = 0;
+		}
+		profile_dump();
+		if(ramstat_check() == 0)
+			ramstat_print();
+		mempool_print();
 	}
 #endif // DHT22_ASYNC
 }
@@ -0,0 +1,230 @@
+/*
+ * mempool.c
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <reent.h>
+#include <cmsis_device.h>
+#include "diag/Trace.h"
+#include "mempool.h"
+
+#ifdef MEMPOOL
+
+// uint64_t storage and sizes in multiples of 8 keep every block 8 byte aligned
+#define MEMPOOL_CLASS(size, count) \
+	typedef char mempool_size_check_##size[(size) % 8 == 0 ? 1 : -1]; \
+	static uint64_t mempool_storage_##size[(size) * (count) / 8];
+MEMPOOL_CLASSES
+#undef MEMPOOL_CLASS
+
+#define MEMPOOL_CLASS(size, count) { size, count, 0, 0, 0, (uint8_t *)mempool_storage_##size, NULL },
+static mempool_t mempools[] = { MEMPOOL_CLASSES };
+#undef MEMPOOL_CLASS
+
+#define MEMPOOL_COUNT (sizeof(mempools) / sizeof(mempools[0]))
+
+static uint8_t mempool_ready;
+
+static uint64_t scratch_arena_buffer[(SCRATCH_ARENA_SIZE + 7) / 8];
+arena_t scratch_arena = { (uint8_t *)scratch_arena_buffer, SCRATCH_ARENA_SIZE, 0, 0, 0 };
+
+/*
+ * malloc may be called before main() by C++ constructors or newlib, so lists are built
+ * by the first call
+ */
+static void mempool_init(void)
+{
+	mempool_t *pool;
+	uint8_t *p;
+	int i;
+
+	for(pool = mempools; pool < mempools + MEMPOOL_COUNT; pool++)
+	{
+		pool->free = NULL;
+		// first block at head of list, just to make dumps easier to read
+		for(i = pool->count, p = pool->storage + pool->size * i; i > 0; i--)
+		{
+			p -= pool->size;
+			((mempool_block_t *)p)->next = pool->free;
+			pool->free = (mempool_block_t *)p;
+		}
+	}
+	mempool_ready = 1;
+}
+
+/*
+ * pool, which storage contains the pointer
+ */
+static mempool_t *mempool_find(const void *p)
+{
+	mempool_t *pool;
+
+	for(pool = mempools; pool < mempools + MEMPOOL_COUNT; pool++)
+		if((const uint8_t *)p >= pool->storage && (const uint8_t *)p < pool->storage + pool->size * pool->count)
+			return pool;
+	return NULL;
+}
+
+void *mempool_alloc(size_t size)
+{
+	mempool_t *pool, *fit = NULL;
+	mempool_block_t *block = NULL;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if(!mempool_ready)
+		mempool_init();
+	for(pool = mempools; pool < mempools + MEMPOOL_COUNT; pool++)
+		if(size <= pool->size) {
+			if(fit == NULL)
+				fit = pool;
+			if(pool->free) {
+				block = pool->free;
+				pool->free = block->next;
+				if(++pool->used > pool->high)
+					pool->high = pool->used;
+				break;
+			}
+		}
+	// failure is counted for the class request belongs to
+	if(block == NULL && fit)
+		fit->failed++;
+	__set_PRIMASK(primask);
+	return block;
+}
+
+void mempool_free(void *p)
+{
+	mempool_t *pool = mempool_find(p);
+	uint32_t primask;
+
+	if(pool == NULL)
+		return;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	((mempool_block_t *)p)->next = pool->free;
+	pool->free = (mempool_block_t *)p;
+	pool->used--;
+	__set_PRIMASK(primask);
+}
+
+size_t mempool_block_size(const void *p)
+{
+	const mempool_t *pool = mempool_find(p);
+	return pool ? pool->size : 0;
+}
+
+const mempool_t *mempool_stats(int n)
+{
+	return n >= 0 && n < (int)MEMPOOL_COUNT ? &mempools[n] : NULL;
+}
+
+void mempool_print(void)
+{
+	const mempool_t *pool;
+
+	for(pool = mempools; pool < mempools + MEMPOOL_COUNT; pool++)
+		trace_printf("pool %3u: %2u of %2u used, high %2u, failed %u\n", pool->size, pool->used, pool->count,
+				pool->high, pool->failed);
+	trace_printf("scratch: %u of %u used, high %u, failed %u\n", (unsigned)scratch_arena.used,
+			(unsigned)scratch_arena.size, (unsigned)scratch_arena.high, (unsigned)scratch_arena.failed);
+}
+
+void arena_init(arena_t *arena, void *buffer, uint32_t size)
+{
+	arena->base = buffer;
+	arena->size = size & ~7;
+	arena->used = arena->high = arena->failed = 0;
+}
+
+void *arena_alloc(arena_t *arena, uint32_t size)
+{
+	void *p;
+
+	size = (size + 7) & ~7;
+	if(size > arena->size - arena->used) {
+		arena->failed++;
+		return NULL;
+	}
+	p = arena->base + arena->used;
+	arena->used += size;
+	if(arena->used > arena->high)
+		arena->high = arena->used;
+	return p;
+}
+
+/*
+ * malloc family for newlib and C++, both plain and reentrant, so that none of newlib
+ * allocator gets linked
+ */
+
+void *_malloc_r(struct _reent *r, size_t size)
+{
+	void *p = mempool_alloc(size);
+	if(p == NULL)
+		r->_errno = ENOMEM;
+	return p;
+}
+
+void _free_r(struct _reent *r, void *p)
+{
+	(void)r;
+	mempool_free(p);
+}
+
+void *_calloc_r(struct _reent *r, size_t count, size_t size)
+{
+	void *p;
+
+	if(size && count > (size_t)-1 / size) {
+		r->_errno = ENOMEM;
+		return NULL;
+	}
+	if((p = _malloc_r(r, count * size)) != NULL)
+		memset(p, 0, count * size);
+	return p;
+}
+
+void *_realloc_r(struct _reent *r, void *p, size_t size)
+{
+	void *q;
+	size_t old;
+
+	if(p == NULL)
+		return _malloc_r(r, size);
+	if(size == 0) {
+		mempool_free(p);
+		return NULL;
+	}
+	// still fits in its block: nothing to do
+	if(size <= (old = mempool_block_size(p)))
+		return p;
+	if((q = _malloc_r(r, size)) != NULL) {
+		memcpy(q, p, old);
+		mempool_free(p);
+	}
+	return q;
+}
+
+void *malloc(size_t size)
+{
+	return _malloc_r(_REENT, size);
+}
+
+void free(void *p)
+{
+	mempool_free(p);
+}
+
+void *calloc(size_t count, size_t size)
+{
+	return _calloc_r(_REENT, count, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+	return _realloc_r(_REENT, p, size);
+}
+
+#endif // MEMPOOL
@@ -0,0 +1,130 @@
+/*
+ * mempool.h
+ *
+ *  Deterministic memory allocation for long running nodes, instead of _sbrk heap, which never
+ *  gives memory back.
+ *  * Pools: fixed size blocks in static storage, one free list per size class, O(1) alloc/free.
+ *    malloc(), free(), realloc(), calloc() and their newlib _r versions are implemented with
+ *    pools, so newlib (printf of floats...) and C++ get them too. Request is served by the
+ *    smallest class that fits and has a free block; there is no fallback to _sbrk.
+ *  * Arena: bump allocator over a buffer, freed all at once by releasing to a mark.
+ *    For scratch memory of one frame: text formatting, glyph decoding.
+ *
+ *  	arena_mark_t mark = arena_mark(&scratch_arena);
+ *  	char *text = arena_alloc(&scratch_arena, 64);
+ *  	...
+ *  	arena_release(&scratch_arena, mark);
+ *
+ *  Every pool and arena keeps usage and high-water mark, mempool_print() shows them.
+ *  Size classes are set by MEMPOOL_CLASSES: size in bytes (multiple of 8, ascending), count.
+ *  Blocks and arena allocations are 8 byte aligned, as AAPCS requires from malloc.
+ *  Pools are safe to use from interrupts, arenas belong to one context.
+ *
+ *  Everything is compiled only if MEMPOOL is defined, otherwise newlib malloc is used and
+ *  mempool_print() is empty.
+ */
+
+#ifndef MEMPOOL_H_
+#define MEMPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MEMPOOL_CLASSES
+#define MEMPOOL_CLASSES \
+	MEMPOOL_CLASS( 16, 16) \
+	MEMPOOL_CLASS( 32,  8) \
+	MEMPOOL_CLASS( 64,  4) \
+	MEMPOOL_CLASS(128,  2) \
+	MEMPOOL_CLASS(256,  2)
+#endif
+
+#ifndef SCRATCH_ARENA_SIZE
+#define SCRATCH_ARENA_SIZE 256
+#endif
+
+typedef struct mempool_block {
+	struct mempool_block *next;
+} mempool_block_t;
+
+typedef struct {
+	uint16_t size, count;          // of blocks
+	uint16_t used, high;           // blocks in use now and at most
+	uint16_t failed;               // requests of this size not served
+	uint8_t *storage;
+	mempool_block_t *free;
+} mempool_t;
+
+typedef struct {
+	uint8_t *base;
+	uint32_t size, used, high;
+	uint32_t failed;
+} arena_t;
+
+typedef uint32_t arena_mark_t;
+
+#ifdef MEMPOOL
+
+/*
+ * arena for scratch memory of main loop
+ */
+extern arena_t scratch_arena;
+
+/*
+ * \brief Allocate block from pools
+ * \return NULL if no class fits or all fitting ones are exhausted
+ */
+void *mempool_alloc(size_t size);
+
+/*
+ * \brief Return block to its pool; NULL and pointers not from pools are ignored
+ */
+void mempool_free(void *p);
+
+/*
+ * \brief Size of block, pointer must be from pools
+ */
+size_t mempool_block_size(const void *p);
+
+/*
+ * \brief Pool by index, for statistics
+ * \return pool, or NULL if there is no such one
+ */
+const mempool_t *mempool_stats(int n);
+
+/*
+ * \brief Print usage of pools and scratch arena with trace_printf()
+ */
+void mempool_print(void);
+
+/*
+ * \brief Use buffer as arena, buffer must be 8 byte aligned, size is rounded down to 8
+ */
+void arena_init(arena_t *arena, void *buffer, uint32_t size);
+
+/*
+ * \brief Allocate 8 byte aligned memory from arena
+ * \return NULL if arena is full
+ */
+void *arena_alloc(arena_t *arena, uint32_t size);
+
+static inline arena_mark_t arena_mark(const arena_t *arena)
+{
+	return arena->used;
+}
+
+/*
+ * \brief Free everything allocated after mark was taken
+ */
+static inline void arena_release(arena_t *arena, arena_mark_t mark)
+{
+	arena->used = mark;
+}
+
+#else // MEMPOOL
+
+static inline void mempool_print(void) {}
+
+#endif // MEMPOOL
+
+#endif /* MEMPOOL_H_ */
@@ -0,0 +1,71 @@
+/*
+ * mf_pack.c
+ */
+
+#include <string.h>
+
+#include <stm32f0xx.h>
+#include "mf_pack.h"
+
+static const mf_pack_t *mf_pack;
+
+/*
+ * CRC-32 of words by hardware unit, same as mf_pack_crc()
+ */
+static uint32_t mf_pack_hw_crc(const uint32_t *data, uint32_t words)
+{
+	uint32_t crc, clock = RCC->AHBENR & RCC_AHBENR_CRCEN;
+
+	RCC->AHBENR |= RCC_AHBENR_CRCEN;
+	CRC->CR = CRC_CR_RESET;
+	while(words--)
+		CRC->DR = *data++;
+	crc = CRC->DR;
+	if(!clock)
+		RCC->AHBENR &= ~RCC_AHBENR_CRCEN;
+	return crc;
+}
+
+int mf_pack_open(const void *pack)
+{
+	const mf_pack_t *p = pack;
+	const mf_pack_entry_t *entry = mf_pack_entries(p);
+	const microfont_t *font;
+	int i;
+
+	if(((uintptr_t)p & 3) || p->magic != MF_PACK_MAGIC || p->version != MF_PACK_VERSION
+			|| (p->size & 3) || p->size < sizeof(mf_pack_t) + p->fonts * sizeof(mf_pack_entry_t))
+		return -1;
+	if(mf_pack_hw_crc((const uint32_t *)(p + 1), (p->size - sizeof(mf_pack_t)) >> 2) != p->checksum)
+		return -1;
+	// checksum is right, but pack could be made by buggy tool
+	for(i = 0; i < p->fonts; i++)
+	{
+		if((entry[i].offset & 3) || entry[i].offset > p->size - sizeof(microfont_t))
+			return -1;
+		font = (const microfont_t *)((const uint8_t *)p + entry[i].offset);
+		if(font->magic != MF_MAGIC || font->version != MF_VERSION || font->size > p->size - entry[i].offset)
+			return -1;
+	}
+	mf_pack = p;
+	return p->fonts;
+}
+
+const microfont_t *mf_pack_font(int n)
+{
+	if(mf_pack == NULL || n < 0 || n >= mf_pack->fonts)
+		return NULL;
+	return (const microfont_t *)((const uint8_t *)mf_pack + mf_pack_entries(mf_pack)[n].offset);
+}
+
+const microfont_t *mf_pack_find(const char *name)
+{
+	int i;
+
+	if(mf_pack == NULL)
+		return NULL;
+	for(i = 0; i < mf_pack->fonts; i++)
+		if(strncmp(mf_pack_entries(mf_pack)[i].name, name, MF_PACK_NAME) == 0)
+			return mf_pack_font(i);
+	return NULL;
+}
@@ -0,0 +1,33 @@
+/*
+ * mf_pack.h
+ *
+ *  Loader of font packs made by fontconv -p (see fontconv/microfont.h).
+ *  Pack is checked once, then fonts are used in place, right from flash, nothing is copied.
+ *  So pack can be flashed to its own place and updated without rebuilding firmware.
+ */
+
+#ifndef MF_PACK_H_
+#define MF_PACK_H_
+
+#include "microfont.h"
+
+/*
+ * \brief Check pack and make it current: magic, version, checksum and every font header
+ * \param pack pack address, word aligned
+ * \return number of fonts, or -1 if pack is broken. Current pack is left as is then.
+ */
+int mf_pack_open(const void *pack);
+
+/*
+ * \brief Font by number
+ * \return font, or NULL if there is no such font or no valid pack
+ */
+const microfont_t *mf_pack_font(int n);
+
+/*
+ * \brief Font by name
+ * \return font, or NULL if there is no such font or no valid pack
+ */
+const microfont_t *mf_pack_find(const char *name);
+
+#endif /* MF_PACK_H_ */
@@ -0,0 +1,106 @@
+/*
+ * pcsample.c
+ */
+
+#ifdef PCSAMPLE
+
+#include <stm32f0xx.h>
+#include "cortexm/ExceptionHandlers.h"
+#include "pcsample.h"
+#include "clock.h"
+
+pcsample_t pcsample;
+
+extern char _etext;
+
+/*
+ * keep counter at 1 MHz, new prescaler is loaded at next update
+ */
+static int pcsample_clock_changed(clock_event_t event, uint32_t hz)
+{
+	if(event == CLOCK_CHANGED)
+		TIM14->PSC = hz / 1000000 - 1;
+	return 0;
+}
+
+void pcsample_init(void)
+{
+	uint32_t size = (uint32_t)(uintptr_t)&_etext - FLASH_BASE;
+	int i;
+
+	pcsample_enable(0);
+	pcsample.magic = PCSAMPLE_MAGIC;
+	pcsample.base = FLASH_BASE;
+	pcsample.buckets = PCSAMPLE_BUCKETS;
+	for(pcsample.shift = 1; (size - 1) >> pcsample.shift >= PCSAMPLE_BUCKETS; pcsample.shift++)
+		;
+	pcsample.samples = pcsample.outside = pcsample.halved = 0;
+	for(i = 0; i < PCSAMPLE_BUCKETS; i++)
+		pcsample.counts[i] = 0;
+
+	// 1 MHz counter clock
+	RCC->APB1ENR |= RCC_APB1ENR_TIM14EN;
+	TIM14->CR1 = 0;
+	TIM14->PSC = SystemCoreClock / 1000000 - 1;
+	TIM14->ARR = 1000000 / PCSAMPLE_RATE - 1;
+	TIM14->EGR = TIM_EGR_UG;
+	TIM14->SR = 0;
+	TIM14->DIER = TIM_DIER_UIE;
+	NVIC_SetPriority(TIM14_IRQn, PCSAMPLE_PRIORITY);
+	clock_register(pcsample_clock_changed);
+	pcsample_enable(1);
+}
+
+void pcsample_enable(int enable)
+{
+	if(enable) {
+		NVIC_EnableIRQ(TIM14_IRQn);
+		TIM14->CR1 |= TIM_CR1_CEN;
+	}
+	else {
+		TIM14->CR1 &= ~TIM_CR1_CEN;
+		NVIC_DisableIRQ(TIM14_IRQn);
+	}
+}
+
+void __attribute__((used)) pcsample_handler_C(ExceptionStackFrame *frame)
+{
+	uint32_t n = (frame->pc - pcsample.base) >> pcsample.shift;
+	int i;
+
+	TIM14->SR = 0;
+	pcsample.samples++;
+	if(n >= PCSAMPLE_BUCKETS) {
+		// PC below base wraps to large number too
+		pcsample.outside++;
+		return;
+	}
+	if(++pcsample.counts[n] == 0xFFFF) {
+		for(i = 0; i < PCSAMPLE_BUCKETS; i++)
+			pcsample.counts[i] >>= 1;
+		pcsample.halved++;
+	}
+}
+
+/*
+ * frame of interrupted code is on process stack, if it was thread using PSP, otherwise on
+ * main stack. The same as HardFault_Handler in exception_handlers.c
+ */
+void __attribute__((naked)) TIM14_IRQHandler(void)
+{
+	asm volatile(
+		" movs r0,#4      \n"
+		" mov r1,lr       \n"
+		" tst r0,r1       \n"
+		" beq 1f          \n"
+		" mrs r0,psp      \n"
+		" b   2f          \n"
+		"1:               \n"
+		" mrs r0,msp      \n"
+		"2:               \n"
+		" ldr r2,=pcsample_handler_C \n"
+		" bx r2"
+	);
+}
+
+#endif // PCSAMPLE
@@ -0,0 +1,76 @@
+/*
+ * pcsample.h
+ *
+ *  Statistical profiler: TIM14 interrupt takes program counter from exception stack frame
+ *  of interrupted code and counts it in histogram of flash addresses. Nothing in measured
+ *  code is changed, so it shows where time goes in main loop.
+ *
+ *  TIM14 has the lowest priority (PCSAMPLE_PRIORITY), so it never delays DHT22 edge interrupt
+ *  or any other handler. The price: only thread code is sampled. A sample due while a handler
+ *  runs is taken right after it returns, so handler time is charged to the main loop code
+ *  which was interrupted. Handler time is measured by PROFILE scopes (profile.h) instead.
+ *
+ *  Histogram stays in RAM, host tool pcprof (top level of repository) maps it to functions
+ *  by ELF symbol table. Dump of the pcsample variable, or of the whole RAM, is enough:
+ *  	(gdb) dump binary value pcsample.bin pcsample
+ *  	pcprof stm32_dht22.elf pcsample.bin
+ *
+ *  Bucket size is chosen by pcsample_init() as the smallest power of 2 that makes code
+ *  (up to _etext) fit in PCSAMPLE_BUCKETS buckets. When a bucket is full, all of them are halved.
+ *  Everything is compiled only if PCSAMPLE is defined, otherwise calls are empty.
+ */
+
+#ifndef PCSAMPLE_H_
+#define PCSAMPLE_H_
+
+#include <stdint.h>
+
+#ifndef PCSAMPLE_BUCKETS
+#define PCSAMPLE_BUCKETS 512  // 2 bytes of RAM each
+#endif
+#ifndef PCSAMPLE_RATE
+#define PCSAMPLE_RATE    997  // Hz, prime to not run in step with periodic code
+#endif
+
+#ifndef PCSAMPLE_PRIORITY
+#define PCSAMPLE_PRIORITY 3   // lowest of Cortex-M0
+#endif
+
+#define PCSAMPLE_MAGIC   0x6d736370 // "pcsm"
+
+/*
+ * layout is read by pcprof, little-endian, no padding
+ */
+typedef struct {
+	uint32_t magic;                     // PCSAMPLE_MAGIC
+	uint32_t base;                      // address of bucket 0
+	uint16_t shift;                     // log2 of bucket size in bytes
+	uint16_t buckets;                   // PCSAMPLE_BUCKETS
+	uint32_t samples;                   // all samples taken
+	uint32_t outside;                   // samples with PC out of histogram (RAM, system memory)
+	uint32_t halved;                    // how many times counts were halved
+	uint16_t counts[PCSAMPLE_BUCKETS];
+} pcsample_t;
+
+#ifdef PCSAMPLE
+
+extern pcsample_t pcsample;
+
+/*
+ * \brief Clear histogram and start sampling at PCSAMPLE_RATE, timer clock is SystemCoreClock
+ */
+void pcsample_init(void);
+
+/*
+ * \brief Stop or resume sampling, histogram is kept
+ */
+void pcsample_enable(int enable);
+
+#else // PCSAMPLE
+
+static inline void pcsample_init(void) {}
+static inline void pcsample_enable(int enable) { (void)enable; }
+
+#endif // PCSAMPLE
+
+#endif /* PCSAMPLE_H_ */
@@ -0,0 +1,128 @@
+/*
+ * profile.c
+ */
+
+#ifdef PROFILE
+
+#include "diag/Trace.h"
+#include "profile.h"
+#include "clock.h"
+
+static profile_region_t profile_regions[PROFILE_MAX_REGIONS];
+static uint8_t profile_count;
+static uint32_t profile_overhead; // ticks of empty region
+static uint32_t profile_hz;       // clock of the last change
+static uint16_t profile_clock_changes;
+
+/*
+ * durations stay in cycles, only count switches, so that dump tells they are mixed
+ */
+static int profile_clock_changed(clock_event_t event, uint32_t hz)
+{
+	if(event == CLOCK_CHANGED && hz != profile_hz) {
+		profile_hz = hz;
+		profile_clock_changes++;
+	}
+	return 0;
+}
+
+void profile_init(void)
+{
+	uint32_t start;
+
+	// boot_start() may have started it already, keep boot timestamps going
+	if(!(TIM2->CR1 & TIM_CR1_CEN)) {
+		RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+		TIM2->PSC = 0;
+		TIM2->ARR = 0xFFFFFFFF;
+		TIM2->EGR = TIM_EGR_UG; // load prescaler
+		TIM2->CR1 = TIM_CR1_CEN;
+	}
+	profile_count = 0;
+	profile_hz = SystemCoreClock;
+	clock_register(profile_clock_changed);
+	profile_reset();
+	start = profile_ticks();
+	profile_overhead = profile_ticks() - start;
+}
+
+void profile_reset(void)
+{
+	int i, j;
+
+	profile_clock_changes = 0;
+	for(i = 0; i < profile_count; i++)
+	{
+		profile_regions[i].count = profile_regions[i].max = 0;
+		profile_regions[i].min = 0xFFFFFFFF;
+		profile_regions[i].total = 0;
+		for(j = 0; j < PROFILE_BUCKETS; j++)
+			profile_regions[i].histogram[j] = 0;
+	}
+}
+
+uint8_t profile_register(const char *name)
+{
+	profile_region_t *r;
+
+	if(profile_count == PROFILE_MAX_REGIONS)
+		return PROFILE_NO_REGION;
+	r = &profile_regions[profile_count];
+	r->name = name;
+	r->count = r->max = 0;
+	r->min = 0xFFFFFFFF;
+	return ++profile_count;
+}
+
+void profile_add(uint8_t region, uint32_t ticks)
+{
+	profile_region_t *r;
+	int bucket;
+
+	if(region > profile_count)
+		return;
+	r = &profile_regions[region - 1];
+	r->count++;
+	r->total += ticks;
+	if(ticks < r->min)
+		r->min = ticks;
+	if(ticks > r->max)
+		r->max = ticks;
+	// bit length of ticks, no clz instruction on M0
+	for(bucket = 0; ticks >> bucket && bucket < PROFILE_BUCKETS - 1; bucket++);
+	if(r->histogram[bucket] != 0xFFFF)
+		r->histogram[bucket]++;
+}
+
+const profile_region_t *profile_region(int n)
+{
+	return n >= 0 && n < profile_count ? &profile_regions[n] : 0;
+}
+
+void profile_dump(void)
+{
+	const profile_region_t *r;
+	int i, j;
+
+	trace_printf("profile: %lu Hz, %u clock changes, empty region %lu ticks\n", SystemCoreClock,
+			profile_clock_changes, profile_overhead);
+	trace_printf("region              count        min        max        avg\n");
+	for(i = 0; i < profile_count; i++)
+	{
+		r = &profile_regions[i];
+		if(r->count == 0) {
+			trace_printf("%-16s %8lu\n", r->name, 0UL);
+			continue;
+		}
+		trace_printf("%-16s %8lu %10lu %10lu %10lu\n", r->name, r->count, r->min, r->max,
+			(uint32_t)(r->total / r->count));
+		// histogram: "<2^n:count", non-empty buckets only
+		trace_printf("  ");
+		for(j = 0; j < PROFILE_BUCKETS; j++)
+			if(r->histogram[j])
+				trace_printf(" <2^%d:%u", j, r->histogram[j]);
+		trace_printf("\n");
+	}
+}
+
+#endif // PROFILE
@@ -0,0 +1,117 @@
+/*
+ * profile.h
+ *
+ *  Profiler of named code regions. Cortex-M0 has no cycle counter, so 32-bit TIM2 runs free
+ *  from the same clock as core (APB prescaler 1): one tick is one cycle, wraps in ~90 s at 48 MHz.
+ *  Durations are cycles of whatever clock ran, also across clock_set(); profile_dump() tells
+ *  how many clock changes there were since the last reset, so mixed ones aren't read as time.
+ *  Every region has count, min, max, total and log2 histogram of durations in static table,
+ *  dumped by profile_dump() through trace channel.
+ *
+ *  	void lcd_scroll(void)
+ *  	{
+ *  		PROFILE_SCOPE("lcd_scroll");
+ *  		...
+ *  	}
+ *
+ *  Region ends when scope is left, by any return. Nested regions are fine, time of inner ones
+ *  is counted in outer one too, with a few dozen cycles of accounting.
+ *  Region shouldn't be entered by thread and interrupt at once, statistics are updated
+ *  without locking.
+ *  Everything is compiled only if PROFILE is defined, otherwise macros and calls are empty.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+#define PROFILE_MAX_REGIONS 12
+#define PROFILE_BUCKETS     32 // bucket n: durations 2^(n-1)..2^n-1 ticks, 0 for zero duration
+
+typedef struct {
+	const char *name;
+	uint32_t count, min, max;
+	uint64_t total;
+	uint16_t histogram[PROFILE_BUCKETS]; // saturated at 65535
+} profile_region_t;
+
+#ifdef PROFILE
+
+#include <stm32f0xx.h>
+
+typedef struct {
+	uint8_t  region; // index in table + 1, PROFILE_NO_REGION if table is full
+	uint32_t start;
+} profile_scope_t;
+
+#define PROFILE_NO_REGION 0xFF
+
+#define PROFILE_CAT_(a, b) a ## b
+#define PROFILE_CAT(a, b)  PROFILE_CAT_(a, b)
+
+/*
+ * \brief Measure time from here to end of enclosing scope. name must be string constant.
+ */
+#define PROFILE_SCOPE(name) \
+	static uint8_t PROFILE_CAT(profile_id_, __LINE__); \
+	profile_scope_t PROFILE_CAT(profile_scope_, __LINE__) __attribute__((cleanup(profile_end))) = \
+		profile_begin(&PROFILE_CAT(profile_id_, __LINE__), name)
+
+/*
+ * \brief Start TIM2 and clear table. Must be called before the first region is entered.
+ */
+void profile_init(void);
+
+/*
+ * \brief Clear statistics, regions stay registered
+ */
+void profile_reset(void);
+
+/*
+ * \brief Print table with trace_printf(): one line per region, then its histogram
+ */
+void profile_dump(void);
+
+/*
+ * \brief Region by index, for showing statistics elsewhere
+ * \return region, or NULL if there is no such one
+ */
+const profile_region_t *profile_region(int n);
+
+uint8_t profile_register(const char *name);
+void profile_add(uint8_t region, uint32_t ticks);
+
+static inline uint32_t profile_ticks(void)
+{
+	return TIM2->CNT;
+}
+
+static inline profile_scope_t profile_begin(uint8_t *id, const char *name)
+{
+	profile_scope_t scope;
+
+	if(*id == 0)
+		*id = profile_register(name);
+	scope.region = *id;
+	scope.start = profile_ticks();
+	return scope;
+}
+
+static inline void profile_end(profile_scope_t *scope)
+{
+	profile_add(scope->region, profile_ticks() - scope->start);
+}
+
+#else // PROFILE
+
+#define PROFILE_SCOPE(name) (void)0
+
+static inline void profile_init(void) {}
+static inline void profile_reset(void) {}
+static inline void profile_dump(void) {}
+static inline const profile_region_t *profile_region(int n) { (void)n; return 0; }
+
+#endif // PROFILE
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,28 @@
+/*
+ * ramfunc.h
+ *
+ *  At 48 MHz flash has one wait state (system_stm32f0xx.c sets FLASH_ACR_LATENCY), so every
+ *  branch of a hot loop costs a fetch stall the prefetch buffer can't hide. Functions marked
+ *  RAMFUNC go to .ramfunc section, which linker script places inside .data: _start copies
+ *  them from flash with the data, and they run from SRAM without wait states.
+ *
+ *  Only with USE_RAMFUNC defined, otherwise RAMFUNC is empty and everything stays in flash.
+ *  Marked now: DHT22 edge ISR (and IRQLAT harness ISR, to measure it the same way), LCD data
+ *  transfer loops. Cost is RAM: size of code, see __ramfunc_start__/__ramfunc_end__ in map file.
+ *
+ *  RAM is 384 MB away from flash, beyond BL range: calls into RAMFUNC are made long
+ *  (long_call), calls from it to flash go through veneers, which linker adds itself.
+ *  To compare timings, build with and without USE_RAMFUNC and look at PROFILE regions
+ *  (profile.h) of lcd_write_raw and at IRQLAT reports (irqlat.h).
+ */
+
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+
+#ifdef USE_RAMFUNC
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#else
+#define RAMFUNC
+#endif
+
+#endif /* RAMFUNC_H_ */
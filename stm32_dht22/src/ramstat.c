@@ -0,0 +1,85 @@
+/*
+ * ramstat.c
+ */
+
+#include <sys/types.h>
+#include "diag/Trace.h"
+#include "ramstat.h"
+
+// linker script symbols
+extern uint32_t _sdata, _edata, __bss_start__, __bss_end__, _noinit, _end_noinit;
+extern uint32_t _Heap_Begin, _Heap_Limit, _Main_Stack_Limit, __stack;
+
+caddr_t _sbrk(int incr);
+
+static uint8_t ramstat_tripped;
+
+/*
+ * heap end is where paint starts, heap takes it as it grows
+ */
+static inline uint32_t *ramstat_heap_end(void)
+{
+	return (uint32_t *)_sbrk(0);
+}
+
+/*
+ * lowest word touched by stack; paint can't be found above it, so scan goes up from heap end
+ */
+static uint32_t *ramstat_stack_bottom(void)
+{
+	uint32_t *p = ramstat_heap_end();
+
+	while(p < &__stack && *p == RAMSTAT_PAINT)
+		p++;
+	return p;
+}
+
+uint32_t ramstat_stack_used(void)
+{
+	return (uint32_t)((char *)&__stack - (char *)ramstat_stack_bottom());
+}
+
+void ramstat_get(ramstat_t *stat)
+{
+	uint32_t *bottom = ramstat_stack_bottom();
+
+	stat->data = (char *)&_edata - (char *)&_sdata;
+	stat->bss = (char *)&__bss_end__ - (char *)&__bss_start__;
+	stat->noinit = (char *)&_end_noinit - (char *)&_noinit;
+	stat->heap_used = (char *)ramstat_heap_end() - (char *)&_Heap_Begin;
+	stat->heap_size = (char *)&_Heap_Limit - (char *)&_Heap_Begin;
+	stat->stack_used = (char *)&__stack - (char *)bottom;
+	stat->stack_size = (char *)&__stack - (char *)&_Main_Stack_Limit;
+	stat->free = (char *)bottom - (char *)ramstat_heap_end();
+	stat->total = (char *)&__stack - (char *)&_sdata;
+}
+
+int ramstat_check(void)
+{
+	const uint32_t *guard = ramstat_heap_end() + RAMSTAT_LOW_STACK / 4;
+
+	if(guard < &__stack && *guard == RAMSTAT_PAINT)
+		return 0;
+	if(!ramstat_tripped) {
+		ramstat_tripped = 1;
+		ramstat_low_stack();
+	}
+	return -1;
+}
+
+void __attribute__((weak)) ramstat_low_stack(void)
+{
+	trace_printf("ramstat: less than %u bytes of stack left\n", RAMSTAT_LOW_STACK);
+	ramstat_print();
+}
+
+void ramstat_print(void)
+{
+	ramstat_t s;
+
+	ramstat_get(&s);
+	trace_printf("RAM %u: data %u, bss %u, noinit %u, heap %u of %u, stack %u of %u, free %u\n",
+			(unsigned)s.total, (unsigned)s.data, (unsigned)s.bss, (unsigned)s.noinit,
+			(unsigned)s.heap_used, (unsigned)s.heap_size, (unsigned)s.stack_used, (unsigned)s.stack_size,
+			(unsigned)s.free);
+}
@@ -0,0 +1,61 @@
+/*
+ * ramstat.h
+ *
+ *  RAM accounting for 8 KB part. _start (system/src/newlib/_startup.c) paints everything
+ *  between .noinit and stack pointer with RAMSTAT_PAINT, so the deepest point stack has
+ *  ever reached is the lowest word above heap that is not painted any more.
+ *  Static sections and heap are measured by linker symbols and _sbrk(0).
+ *
+ *  Free stack is the never touched gap between heap end and the deepest stack point,
+ *  it may be less than reserved stack size (__Main_Stack_Size): heap limit doesn't stop stack.
+ *  ramstat_check() looks at one word only, so it's cheap enough for main loop or SysTick:
+ *  when it finds that stack came closer than RAMSTAT_LOW_STACK bytes to heap,
+ *  it calls ramstat_low_stack(), which is weak and may be redefined.
+ */
+
+#ifndef RAMSTAT_H_
+#define RAMSTAT_H_
+
+#include <stdint.h>
+
+#define RAMSTAT_PAINT     0xC5C5C5C5 // the same as STACK_PAINT_VALUE in _startup.c
+#ifndef RAMSTAT_LOW_STACK
+#define RAMSTAT_LOW_STACK 256        // bytes, like _Minimum_Stack_Size of linker script
+#endif
+
+typedef struct {
+	uint32_t data, bss, noinit;      // static sections
+	uint32_t heap_used, heap_size;   // given by _sbrk, up to _Heap_Limit
+	uint32_t stack_used, stack_size; // high-water mark, reserved stack
+	uint32_t free;                   // never touched by heap or stack
+	uint32_t total;                  // all RAM
+} ramstat_t;
+
+/*
+ * \brief Collect sizes, stack high-water mark is found by scanning painted area
+ */
+void ramstat_get(ramstat_t *stat);
+
+/*
+ * \brief Most of stack ever used, in bytes
+ */
+uint32_t ramstat_stack_used(void);
+
+/*
+ * \brief Check if free stack dropped below RAMSTAT_LOW_STACK, call ramstat_low_stack() if so
+ * \return 0 if there is enough free stack
+ */
+int ramstat_check(void);
+
+/*
+ * \brief Called by ramstat_check() once, when free stack is low. Default prints warning
+ *        through trace channel.
+ */
+void ramstat_low_stack(void);
+
+/*
+ * \brief Print RAM map with trace_printf()
+ */
+void ramstat_print(void);
+
+#endif /* RAMSTAT_H_ */
@@ -8,6 +8,7 @@
 
 // ----------------------------------------------------------------------------
 
+#include <stdint.h>
 #include <unistd.h>
 
 // ----------------------------------------------------------------------------
@@ -27,7 +28,8 @@
 // By default the trace messages are forwarded to the ITM output,
 // but can be rerouted via any device or completely suppressed by
 // changing the definitions required in system/src/diag/trace_impl.c
-// (currently OS_USE_TRACE_ITM, OS_USE_TRACE_SEMIHOSTING_DEBUG/_STDOUT).
+// (currently OS_USE_TRACE_ITM, OS_USE_TRACE_SEMIHOSTING_DEBUG/_STDOUT,
+// OS_USE_TRACE_RINGBUF/_RINGBUF_USART).
 //
 // When TRACE is not defined, all functions are inlined to empty bodies.
 // This has the advantage that the trace call do not need to be conditionally
@@ -62,6 +64,21 @@ extern "C"
   void
   trace_dump_args(int argc, char* argv[]);
 
+#if defined(OS_USE_TRACE_RINGBUF) || defined(OS_USE_TRACE_RINGBUF_USART)
+  // Bytes of messages dropped, because the RAM ring buffer was full.
+  extern volatile uint32_t trace_dropped;
+#endif
+
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+  // The baud rate is derived from SystemCoreClock, call these around
+  // clock changes.
+  void
+  trace_usart_clock_changing (void);
+
+  void
+  trace_usart_clock_changed (void);
+#endif
+
 #if defined(__cplusplus)
 }
 #endif
@@ -18,6 +18,12 @@
 //#define OS_USE_TRACE_ITM
 //#define OS_USE_TRACE_SEMIHOSTING_DEBUG
 //#define OS_USE_TRACE_SEMIHOSTING_STDOUT
+//#define OS_USE_TRACE_RINGBUF
+//#define OS_USE_TRACE_RINGBUF_USART
+
+#if defined(OS_USE_TRACE_RINGBUF_USART) && !defined(OS_USE_TRACE_RINGBUF)
+#define OS_USE_TRACE_RINGBUF
+#endif
 
 #if !(defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__))
 #if defined(OS_USE_TRACE_ITM)
@@ -51,12 +57,25 @@ static ssize_t
 _trace_write_semihosting_debug(const char* buf, size_t nbyte);
 #endif
 
+#if defined(OS_USE_TRACE_RINGBUF)
+static ssize_t
+_trace_write_ringbuf(const char* buf, size_t nbyte);
+#endif
+
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+static void
+_trace_usart_init (void);
+#endif
+
 // ----------------------------------------------------------------------------
 
 void
 trace_initialize(void)
 {
   // For regular ITM / semihosting, no inits required.
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+  _trace_usart_init ();
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -74,6 +93,8 @@ trace_write (const char* buf __attribute__((unused)),
   return _trace_write_semihosting_stdout(buf, nbyte);
 #elif defined(OS_USE_TRACE_SEMIHOSTING_DEBUG)
   return _trace_write_semihosting_debug(buf, nbyte);
+#elif defined(OS_USE_TRACE_RINGBUF)
+  return _trace_write_ringbuf(buf, nbyte);
 #endif
 
   return -1;
@@ -246,6 +267,238 @@ _trace_write_semihosting_debug (const char* buf, size_t nbyte)
 
 #endif // OS_USE_TRACE_SEMIHOSTING_DEBUG
 
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_TRACE_RINGBUF)
+
+// Semihosting halts the core on a BKPT for every message, for milliseconds,
+// and Cortex-M0 has no ITM. This channel only copies the message to a RAM
+// ring buffer, so tracing costs microseconds and never stops the core.
+//
+// The buffer is read in the background, in one of two ways:
+// - by the debugger, which reads target memory while the core runs.
+//   The control block has the SEGGER RTT layout, so J-Link RTT Viewer
+//   finds it by its id, and so does OpenOCD:
+//     monitor rtt setup 0x20000000 0x2000 "SEGGER RTT"
+//     monitor rtt start
+//     monitor rtt server start 9090 0
+// - by USART1 TX (PA9) with DMA, if OS_USE_TRACE_RINGBUF_USART is defined.
+//   Then the debugger must not read the buffer.
+//
+// Messages are written by thread code and by interrupt handlers. Cortex-M0 has
+// no exclusive access instructions, so interrupts are masked for a few
+// instructions only: to reserve space and to commit it. The copy itself runs
+// with interrupts enabled. Writers nest like interrupts do, so the outermost
+// one commits all of them. When the buffer is full, the whole message is
+// dropped and counted in trace_dropped; the writer never waits.
+
+#if !defined(OS_INTEGER_TRACE_RINGBUF_SIZE)
+#define OS_INTEGER_TRACE_RINGBUF_SIZE  (512)
+#endif
+
+#if (OS_INTEGER_TRACE_RINGBUF_SIZE & (OS_INTEGER_TRACE_RINGBUF_SIZE - 1))
+#error "OS_INTEGER_TRACE_RINGBUF_SIZE must be a power of 2"
+#endif
+
+typedef struct
+{
+  const char* name;
+  char* buffer;
+  uint32_t size;
+  volatile uint32_t write; // offset of the next byte to write, moved by target
+  volatile uint32_t read; // offset of the next byte to read, moved by reader
+  uint32_t flags; // 0: skip messages, which don't fit
+} trace_rtt_buffer_t;
+
+typedef struct
+{
+  char id[16];
+  int32_t up_buffers;
+  int32_t down_buffers;
+  trace_rtt_buffer_t up[1];
+} trace_rtt_t;
+
+static char trace_ringbuf_data[OS_INTEGER_TRACE_RINGBUF_SIZE];
+
+trace_rtt_t trace_ringbuf __attribute__((used)) =
+  {
+    "SEGGER RTT", 1, 0,
+      {
+        { "Terminal", trace_ringbuf_data, OS_INTEGER_TRACE_RINGBUF_SIZE, 0, 0, 0 } } };
+
+volatile uint32_t trace_dropped;
+
+// Space taken by writers, but not committed yet.
+static uint32_t trace_reserved;
+static uint32_t trace_writers;
+
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+static void
+_trace_usart_kick (void);
+#endif
+
+static ssize_t
+_trace_write_ringbuf (const char* buf, size_t nbyte)
+{
+  trace_rtt_buffer_t* up = &trace_ringbuf.up[0];
+  uint32_t primask, start, mask = OS_INTEGER_TRACE_RINGBUF_SIZE - 1;
+
+  primask = __get_PRIMASK ();
+  __disable_irq ();
+  // one byte is always free, so write == read means empty
+  if (nbyte > ((up->read - trace_reserved - 1) & mask))
+    {
+      trace_dropped += nbyte;
+      __set_PRIMASK (primask);
+      return (ssize_t) nbyte;
+    }
+  start = trace_reserved;
+  trace_reserved = (trace_reserved + nbyte) & mask;
+  trace_writers++;
+  __set_PRIMASK (primask);
+
+  for (size_t i = 0; i < nbyte; i++)
+    trace_ringbuf_data[(start + i) & mask] = buf[i];
+
+  // __disable_irq() is a compiler barrier, data is stored before commit
+  __disable_irq ();
+  if (--trace_writers == 0)
+    up->write = trace_reserved;
+  __set_PRIMASK (primask);
+
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+  _trace_usart_kick ();
+#endif
+
+  return (ssize_t) nbyte;
+}
+
+#endif // OS_USE_TRACE_RINGBUF
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_TRACE_RINGBUF_USART)
+
+// USART1 TX is PA9, AF1, and its DMA request is served by channel 2.
+// Only the TX pin is taken. The baud rate is set from SystemCoreClock,
+// with APB clock equal to AHB clock.
+
+#if !defined(OS_INTEGER_TRACE_USART_BAUDRATE)
+#define OS_INTEGER_TRACE_USART_BAUDRATE  (115200)
+#endif
+
+// Length of the chunk being sent by DMA.
+static uint32_t trace_usart_chunk;
+
+// No new chunks are started while the clock is being changed.
+static uint8_t trace_usart_hold;
+
+void
+DMA1_Channel2_3_IRQHandler (void);
+
+static void
+_trace_usart_init (void)
+{
+  RCC->AHBENR |= RCC_AHBENR_GPIOAEN | RCC_AHBENR_DMA1EN;
+  RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+
+  GPIOA->AFR[1] = (GPIOA->AFR[1] & ~GPIO_AFRH_AFR9) | (1 << 4);
+  GPIOA->MODER = (GPIOA->MODER & ~GPIO_MODER_MODER9) | GPIO_MODER_MODER9_1;
+
+  USART1->CR1 = 0;
+  USART1->BRR = (SystemCoreClock + OS_INTEGER_TRACE_USART_BAUDRATE / 2)
+      / OS_INTEGER_TRACE_USART_BAUDRATE;
+  USART1->CR3 = USART_CR3_DMAT;
+  USART1->CR1 = USART_CR1_TE | USART_CR1_UE;
+
+  DMA1_Channel2->CCR = 0;
+  DMA1_Channel2->CPAR = (uint32_t) &USART1->TDR;
+  NVIC_EnableIRQ (DMA1_Channel2_3_IRQn);
+}
+
+// Start sending the oldest committed bytes, if DMA is idle.
+// The chunk ends at the buffer end, the rest goes in the next one.
+static void
+_trace_usart_kick (void)
+{
+  trace_rtt_buffer_t* up = &trace_ringbuf.up[0];
+  uint32_t primask, read, write;
+
+  primask = __get_PRIMASK ();
+  __disable_irq ();
+  if ((USART1->CR1 & USART_CR1_UE) == 0)
+    _trace_usart_init ();
+  if ((DMA1_Channel2->CCR & DMA_CCR_EN) == 0 && !trace_usart_hold)
+    {
+      read = up->read;
+      write = up->write;
+      if (write != read)
+        {
+          trace_usart_chunk = (write > read ? write : up->size) - read;
+          DMA1_Channel2->CMAR = (uint32_t) (up->buffer + read);
+          DMA1_Channel2->CNDTR = trace_usart_chunk;
+          DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE
+              | DMA_CCR_EN;
+        }
+    }
+  __set_PRIMASK (primask);
+}
+
+// Channel 3 is used by LCD SPI, without interrupts, so only channel 2 is
+// served here.
+void
+DMA1_Channel2_3_IRQHandler (void)
+{
+  trace_rtt_buffer_t* up = &trace_ringbuf.up[0];
+
+  if (DMA1->ISR & DMA_ISR_TCIF2)
+    {
+      DMA1->IFCR = DMA_IFCR_CTCIF2;
+      DMA1_Channel2->CCR = 0;
+      up->read = (up->read + trace_usart_chunk) & (up->size - 1);
+      _trace_usart_kick ();
+    }
+}
+
+// Stop the chunk being sent; the bytes DMA has not taken yet stay in
+// the buffer. Then wait for the last byte to go out at the old rate.
+void
+trace_usart_clock_changing (void)
+{
+  trace_rtt_buffer_t* up = &trace_ringbuf.up[0];
+  uint32_t primask;
+
+  primask = __get_PRIMASK ();
+  __disable_irq ();
+  trace_usart_hold = 1;
+  if (DMA1_Channel2->CCR & DMA_CCR_EN)
+    {
+      DMA1_Channel2->CCR = 0;
+      DMA1->IFCR = DMA_IFCR_CTCIF2;
+      up->read = (up->read + trace_usart_chunk - DMA1_Channel2->CNDTR)
+          & (up->size - 1);
+    }
+  __set_PRIMASK (primask);
+
+  if (USART1->CR1 & USART_CR1_UE)
+    {
+      while ((USART1->ISR & USART_ISR_TC) == 0)
+        ;
+    }
+}
+
+// BRR can be written only with the USART disabled; the next kick
+// initialises it again with the new SystemCoreClock.
+void
+trace_usart_clock_changed (void)
+{
+  USART1->CR1 = 0;
+  trace_usart_hold = 0;
+  _trace_usart_kick ();
+}
+
+#endif // OS_USE_TRACE_RINGBUF_USART
+
 #endif // TRACE
 
 // ----------------------------------------------------------------------------
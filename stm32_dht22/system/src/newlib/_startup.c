@@ -40,6 +40,15 @@
 #define OS_INCLUDE_STARTUP_GUARD_CHECKS (1)
 #endif
 
+// Fill free RAM between the static sections and the stack pointer with
+// a known value, so that the stack high-water mark can be found later.
+#if !defined(OS_INCLUDE_STARTUP_STACK_PAINT)
+#define OS_INCLUDE_STARTUP_STACK_PAINT (1)
+#endif
+
+// Must be kept in sync with RAMSTAT_PAINT in src/ramstat.h.
+#define STACK_PAINT_VALUE (0xC5C5C5C5)
+
 // ----------------------------------------------------------------------------
 
 #if !defined(OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS)
@@ -68,9 +77,24 @@ extern unsigned int __bss_regions_array_start;
 extern unsigned int __bss_regions_array_end;
 #endif
 
+#if (OS_INCLUDE_STARTUP_STACK_PAINT)
+// End of the last static section (.noinit); defined in linker script
+extern unsigned int _end_noinit;
+#endif
+
 extern void
 __initialize_args (int*, char***);
 
+// Boot phase timestamps, if the application provides them (src/boot.c).
+// Called before DATA and BSS are initialised, so they may use only
+// .noinit memory.
+extern void
+__attribute__((weak))
+boot_start (void);
+extern void
+__attribute__((weak))
+boot_mark (const char* phase);
+
 // main() is the entry point for newlib based applications.
 // By default, there are no arguments, but this can be customised
 // by redefining __initialize_args(), which is done when the
@@ -98,6 +122,9 @@ __initialize_data (unsigned int* from, unsigned int* region_begin,
 void
 __initialize_bss (unsigned int* region_begin, unsigned int* region_end);
 
+void
+__paint_stack (unsigned int* region_begin);
+
 void
 __run_init_array (void);
 
@@ -117,9 +144,21 @@ __attribute__((always_inline))
 __initialize_data (unsigned int* from, unsigned int* region_begin,
 		   unsigned int* region_end)
 {
-  // Iterate and copy word by word.
+  // Copy four words per iteration with LDM/STM (low registers only,
+  // to fit ARMv6-M), then the remaining words one by one.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+  while (region_end - p >= 4)
+    {
+      asm volatile (
+          " ldmia %[from]!, {r2-r5} \n"
+          " stmia %[p]!, {r2-r5}"
+
+          : [from] "+l" (from), [p] "+l" (p)
+          : /* Inputs */
+          : "r2", "r3", "r4", "r5", "memory"
+      );
+    }
   while (p < region_end)
     *p++ = *from++;
 }
@@ -128,13 +167,45 @@ inline void
 __attribute__((always_inline))
 __initialize_bss (unsigned int* region_begin, unsigned int* region_end)
 {
-  // Iterate and clear word by word.
+  // Clear four words per iteration with STM, then the remaining words.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+  register unsigned int z0 asm ("r2") = 0;
+  register unsigned int z1 asm ("r3") = 0;
+  register unsigned int z2 asm ("r4") = 0;
+  register unsigned int z3 asm ("r5") = 0;
+  while (region_end - p >= 4)
+    {
+      asm volatile (
+          " stmia %[p]!, {r2-r5}"
+
+          : [p] "+l" (p)
+          : "r" (z0), "r" (z1), "r" (z2), "r" (z3)
+          : "memory"
+      );
+    }
   while (p < region_end)
     *p++ = 0;
 }
 
+#if (OS_INCLUDE_STARTUP_STACK_PAINT)
+
+inline void
+__attribute__((always_inline))
+__paint_stack (unsigned int* region_begin)
+{
+  // Paint up to the current stack pointer; nothing below it is used yet,
+  // and being inlined, this loop does not push anything itself.
+  unsigned int *p = region_begin;
+  unsigned int *sp;
+
+  asm volatile ("mov %0, sp" : "=r" (sp));
+  while (p < sp)
+    *p++ = STACK_PAINT_VALUE;
+}
+
+#endif
+
 // These magic symbols are provided by the linker.
 extern void
 (*__preinit_array_start[]) (void) __attribute__((weak));
@@ -234,6 +305,9 @@ _start (void)
 
   __initialize_hardware_early ();
 
+  if (boot_start)
+    boot_start ();
+
   // Use Old Style DATA and BSS section initialisation,
   // that will manage a single BSS sections.
 
@@ -269,6 +343,9 @@ _start (void)
     }
 #endif
 
+  if (boot_mark)
+    boot_mark ("data");
+
 #if defined(DEBUG) && (OS_INCLUDE_STARTUP_GUARD_CHECKS)
   __bss_begin_guard = BSS_GUARD_BAD_VALUE;
   __bss_end_guard = BSS_GUARD_BAD_VALUE;
@@ -297,10 +374,24 @@ _start (void)
     }
 #endif
 
+  if (boot_mark)
+    boot_mark ("bss");
+
+#if (OS_INCLUDE_STARTUP_STACK_PAINT)
+  // Paint the heap and the stack (inlined).
+  __paint_stack (&_end_noinit);
+
+  if (boot_mark)
+    boot_mark ("paint");
+#endif
+
   // Hook to continue the initialisations. Usually compute and store the
   // clock frequency in the global CMSIS variable, cleared above.
   __initialize_hardware ();
 
+  if (boot_mark)
+    boot_mark ("hardware");
+
   // Get the argc/argv (useful in semihosting configurations).
   int argc;
   char** argv;
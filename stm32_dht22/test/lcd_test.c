@@ -0,0 +1,319 @@
+/*
+ * lcd_test.c
+ *
+ *  Host test of framebuffer memory operations, clearing, scrolling and microfont output.
+ *  Display library is compiled together with a fake driver, which records
+ *  what would be sent to the controller. Real drivers get stubs of SPI port, so only
+ *  their argument checks can run. Build and run from this directory:
+ *
+ *  gcc -DSTM32F051 -DUSE_STDPERIPH_DRIVER -I../src -I../include -I../system/include \
+ *      -I../system/include/cmsis -I../system/include/stm32f0-stdperiph -I../../fontconv lcd_test.c -o lcd_test
+ *  ./lcd_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/lcd_nokia.c"
+#include "../src/lcd_mem.c"
+#include "../src/lcd_microfont.c"
+#include "../src/lcd_drv_ssd1306.c"
+
+uint32_t SystemCoreClock;
+
+// SPI port of real drivers: only calls made before hardware is touched are expected
+static int spi_calls;
+void lcd_spi_init(uint16_t data_size) { spi_calls++; }
+void lcd_spi_set_dc(int data) { spi_calls++; }
+void lcd_spi_wait(void) { spi_calls++; }
+void lcd_spi_fill(uint8_t value, int length) { spi_calls++; }
+void lcd_spi_write(const uint8_t *data, int length) { spi_calls++; }
+
+// fake controller: video RAM, address pointer, number of bytes sent
+static uint8_t vram[LCD_MAX_PAGES * LCD_MAX_WIDTH];
+static int vram_ptr, vram_width = 96, sent;
+static int failures;
+
+static uint32_t fake_init(int step)
+{
+	// reset, like real ones: two delays
+	if(step < 2)
+		return 5 + 15 * step;
+	memset(vram, 0x55, sizeof(vram));
+	return 0;
+}
+
+static void fake_set_address(uint8_t page, uint8_t column)
+{
+	vram_ptr = page * vram_width + column;
+}
+
+static void fake_write_data(const uint8_t *data, int length)
+{
+	sent += length;
+	while(length--)
+		vram[vram_ptr++] = *data++;
+}
+
+static void fake_fill(uint8_t value, int length)
+{
+	sent += length;
+	while(length--)
+		vram[vram_ptr++] = value;
+}
+
+static void fake_write_command(uint8_t command)
+{
+}
+
+static void fake_set_power(lcd_power_t mode)
+{
+}
+
+const lcd_driver_t lcd_nokia1100_driver = {
+	{ 96, 68 },
+	fake_init,
+	fake_set_address,
+	fake_write_data,
+	fake_fill,
+	fake_write_command,
+	fake_set_power,
+	NULL
+};
+
+// 128 px wide, like SSD1306: 6 px glyphs don't fill a line
+static const lcd_driver_t fake_wide_driver = {
+	{ 128, 64 },
+	fake_init,
+	fake_set_address,
+	fake_write_data,
+	fake_fill,
+	fake_write_command,
+	fake_set_power,
+	NULL
+};
+
+static void check(int condition, const char *what)
+{
+	if(!condition) {
+		printf("FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static int all_equal(const uint8_t *p, int size, uint8_t value)
+{
+	while(size--)
+		if(*p++ != value)
+			return 0;
+	return 1;
+}
+
+static void test_mem(void)
+{
+	uint32_t buf[40];
+	int i, n;
+
+	// every length, including the non-unrolled tail
+	for(n = 0; n < 12; n++)
+	{
+		memset(buf, 0xAA, sizeof(buf));
+		lcd_fill32(buf + 1, 0x12345678, n);
+		check(buf[0] == 0xAAAAAAAA && buf[n + 1] == 0xAAAAAAAA, "fill32 stays in bounds");
+		for(i = 0; i < n; i++)
+			check(buf[i + 1] == 0x12345678, "fill32 fills");
+	}
+	// overlapping move, distances below and above unroll factor
+	for(n = 1; n < 6; n++)
+	{
+		for(i = 0; i < 40; i++)
+			buf[i] = i;
+		lcd_move32(buf, buf + n, 40 - n);
+		for(i = 0; i < 40 - n; i++)
+			check(buf[i] == (uint32_t)(i + n), "move32 moves overlapping areas");
+		check(buf[39] == 39, "move32 stays in bounds");
+	}
+}
+
+static void test_clear(void)
+{
+	uint32_t fb[96 * 9 / 4 + 1];
+
+	// framebuffer mode: whole 96x9 buffer, not a pointer-size piece of it
+	memset(fb, 0xFF, sizeof(fb));
+	lcd_init(NULL, fb, NULL);
+	sent = 0;
+	lcd_clear();
+	check(all_equal((uint8_t *)fb, 96 * 9, 0), "clear zeroes whole framebuffer");
+	check(fb[96 * 9 / 4] == 0xFFFFFFFF, "clear stays in framebuffer bounds");
+	check(sent == 96 * 9 && all_equal(vram, 96 * 9, 0), "clear sends whole framebuffer");
+
+	// dumb mode: zeros streamed to the whole screen
+	lcd_init(NULL, NULL, NULL);
+	sent = 0;
+	lcd_clear();
+	check(sent == 96 * 9 && all_equal(vram, 96 * 9, 0), "dumb clear sends whole screen");
+}
+
+static void test_init(void)
+{
+	// steps of fake driver: 5 ms, 20 ms, done
+	memset(vram, 0, sizeof(vram));
+	lcd_init_start(NULL, NULL, 1000);
+	check(!lcd_init_poll(1004), "init waits for reset");
+	check(!lcd_init_poll(1005) && !lcd_init_poll(1024), "init waits after reset");
+	check(lcd_init_poll(1025) && vram[0] == 0x55, "init is done in time");
+	check(lcd_init_poll(1026), "init stays done");
+
+	// late poll: delay is counted from the step, not from when it was due; timebase wraps
+	lcd_init_start(NULL, NULL, 0xFFFFFFFE);
+	check(!lcd_init_poll(2), "init waits over timebase wrap");
+	check(!lcd_init_poll(100) && !lcd_init_poll(119) && lcd_init_poll(120), "init delays follow late steps");
+}
+
+static void test_scroll(void)
+{
+	uint32_t fb[96 * 9 / 4];
+	uint8_t *p = (uint8_t *)fb;
+	int i;
+
+	lcd_init(NULL, fb, NULL);
+	for(i = 0; i < 96 * 9; i++)
+		p[i] = i / 96 + 1;
+	sent = 0;
+	lcd_scroll();
+	for(i = 0; i < 96 * 7; i++)
+		if(p[i] != i / 96 + 2)
+			break;
+	check(i == 96 * 7, "scroll moves lines up");
+	check(all_equal(p + 96 * 7, 96, 0), "scroll clears last text line");
+	check(all_equal(p + 96 * 8, 96, 9), "scroll keeps incomplete page");
+	check(sent == 96 * 9 && memcmp(vram, p, 96 * 9) == 0, "scroll shows framebuffer");
+	lcd_set_cursor(8, 0);
+	check(lcd_state.current_line == 0, "cursor doesn't go to partial page");
+}
+
+static void test_sleep(void)
+{
+	// dumb mode: sleeping controller gets data, and must get address too
+	lcd_init(NULL, NULL, NULL);
+	lcd_clear();
+	lcd_set_power(LCD_POWER_SLEEP);
+	lcd_set_cursor(2, 12);
+	lcd_putc('A');
+	check(memcmp(vram + 96 * 2 + 12, lcd_chars6x8['A' - 32], LCD_CHARS6X8_WIDTH) == 0, "dumb mode writes at cursor while asleep");
+	lcd_set_power(LCD_POWER_ON);
+}
+
+static void test_partial(void)
+{
+	spi_calls = 0;
+	check(lcd_ssd1306_driver.set_partial(0, 1) == -1, "SSD1306 rejects single page");
+	check(lcd_ssd1306_driver.set_partial(6, 4) == -1, "SSD1306 rejects pages past COM63");
+	check(lcd_ssd1306_driver.set_partial(7, 2) == -1, "SSD1306 rejects last page and beyond");
+	check(spi_calls == 0, "rejected partial range sends nothing");
+	lcd_init(NULL, NULL, NULL);
+	check(lcd_set_partial(0, 2) == -1, "partial mode of driver without it");
+}
+
+static void test_wrap(void)
+{
+	uint32_t fb[128 * 8 / 4];
+	uint8_t *p = (uint8_t *)fb;
+	int i;
+
+	vram_width = 128;
+	lcd_init(&fake_wide_driver, fb, NULL);
+	lcd_set_flags(0);
+	lcd_clear();
+	// 21 glyphs fill 126 px, 22nd goes to next line, then 7 lines more wrap to the top
+	for(i = 0; i < 21 * 8 + 1; i++)
+		lcd_putc('A' + i % 21);
+	check(lcd_state.current_line == 0 && lcd_state.current_column == 6, "wide display wraps");
+	check(memcmp(vram, p, 128 * 8) == 0, "wide display matches framebuffer after wrap");
+	check(all_equal(vram + 126, 2, 0), "wide display keeps tail columns");
+	vram_width = 96;
+}
+
+static void test_microfont(void)
+{
+	// 'A' only, 2x10: full column, then every other pixel
+	static const uint32_t font_block[] = {
+		0x0002face, 0x0001010a, 0xffff0001, 0x00000024,
+		0x00000041, 0x00000001,
+		0x00000000,
+		0x000aafff, 0x00000000
+	};
+	// the same in page order: width byte, then bytes of both pages
+	static const uint32_t pages_block[] = {
+		0x0802face, 0x0001080a, 0xffff0001, 0x00000028,
+		0x00000041, 0x00000001,
+		0x00000000,
+		0x0355ff01, 0x00000001, 0x00000000
+	};
+	// glyph box: cell 2x10, only pixel (1,5) is stored as 1x1 box
+	static const uint32_t box_block[] = {
+		0x8002face, 0x0001010a, 0xffff0001, 0x00000024,
+		0x00000041, 0x00000001,
+		0x00000000,
+		0x00000857, 0x00000000
+	};
+	const microfont_t *font = (const microfont_t *)font_block;
+	const microfont_t *pages_font = (const microfont_t *)pages_block;
+	const microfont_t *box_font = (const microfont_t *)box_block;
+	uint32_t fb[96 * 9 / 4];
+	uint8_t *p = (uint8_t *)fb;
+
+	lcd_init(NULL, fb, NULL);
+	lcd_clear();
+	lcd_set_cursor(1, 10);
+	check(lcd_mf_putc(font, 'A') == 2, "microfont glyph width");
+	check(p[96 + 10] == 0xFF && p[96 + 11] == 0x55, "microfont glyph top page");
+	check(p[192 + 10] == 0x03 && p[192 + 11] == 0x01, "microfont glyph bottom page");
+	check(vram[96 + 11] == 0x55 && vram[192 + 10] == 0x03, "microfont glyph is shown");
+	check(lcd_state.current_line == 1 && lcd_state.current_column == 12, "microfont cursor advance");
+	// missing char, no fallback in font
+	check(lcd_mf_putc(font, 'B') == 0 && lcd_state.current_column == 12, "microfont missing char");
+	// wrap by font height
+	lcd_set_cursor(1, 94);
+	lcd_mf_puts(font, (const unsigned char *)"A");
+	check(lcd_state.current_line == 3 && lcd_state.current_column == 0, "microfont wraps by font height");
+	// the last text line, glyph's bottom goes to partial page
+	lcd_clear();
+	lcd_set_cursor(7, 20);
+	check(lcd_mf_putc(font, 'A') == 2, "microfont glyph on last line");
+	check(vram[96 * 8 + 20] == 0x03 && vram[20] == 0, "microfont glyph reaches partial page");
+
+	// same glyph in page order, copied straight to framebuffer
+	lcd_clear();
+	lcd_set_cursor(1, 10);
+	check(lcd_mf_putc(pages_font, 'A') == 2, "page order glyph width");
+	check(p[96 + 10] == 0xFF && p[96 + 11] == 0x55 && p[192 + 10] == 0x03 && p[192 + 11] == 0x01,
+		"page order glyph is copied");
+
+	// box glyph clears its cell, but not rows below font height
+	memset(fb, 0xFF, sizeof(fb));
+	lcd_set_cursor(1, 10);
+	check(lcd_mf_putc(box_font, 'A') == 2, "box glyph width");
+	check(p[96 + 10] == 0x00 && p[96 + 11] == 0x20, "box glyph top page");
+	check(p[192 + 10] == 0xFC && p[192 + 11] == 0xFC, "box glyph keeps next line");
+	check(p[96 + 12] == 0xFF, "box glyph stays in cell");
+}
+
+int main(int argc, char *argv[])
+{
+	test_mem();
+	test_clear();
+	test_init();
+	test_scroll();
+	test_sleep();
+	test_partial();
+	test_wrap();
+	test_microfont();
+	if(failures) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all tests passed\n");
+	return 0;
+}